@@ -0,0 +1,288 @@
+#include "batch.h"
+
+#include "cell.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HAVE_AVX2_KERNEL
+#include <immintrin.h>
+#endif
+
+#define GROUP_LANES 8
+#define NO_ROBOT SIZE_MAX
+
+/**
+ * Biggest map that can be simulated by the vectorized kernel. Indices must fit
+ * into signed 32-bit lanes and the counters of Brent's algorithm must be able
+ * to reach the length of the longest cycle (4 states per cell).
+ */
+#define KERNEL_MAX_CELLS ((size_t) 1 << 29)
+
+/**
+ * @brief Shared state of the simulation.
+ */
+struct batch
+{
+    const char *map;
+    size_t width;
+    size_t height;
+    size_t count;
+    const size_t *positions;
+    const char *directions;
+    enum end_state_t *results;
+
+    size_t next;
+    size_t steps;
+};
+
+/**
+ * @brief Walks a single robot over the byte map, used when the vectorized
+ * simulator is not available.
+ * @param batch Simulation that the robot belongs to.
+ * @param robot Index of the robot.
+ * @returns End state of the robot.
+ */
+static enum end_state_t walk_one(struct batch *batch, size_t robot)
+{
+    size_t position = batch->positions[robot];
+    if (position >= batch->width * batch->height) {
+        return OUT_OF_BOUNDS;
+    }
+
+    struct robot hare = { position / batch->width, position % batch->width, direction_from_char(batch->directions[robot]) };
+    struct cycle_detector detector = { hare, 1, 1 };
+
+    for (;;) {
+        batch->steps++;
+
+        enum cell_t cell = cell_from_char(batch->map[hare.row * batch->width + hare.col]);
+        enum end_state_t state = enter_cell(cell, &hare.direction);
+        if (state != NONE) {
+            return state;
+        }
+        if (!move_robot(&hare, batch->width, batch->height)) {
+            return OUT_OF_BOUNDS;
+        }
+        if (cycle_detected(&detector, &hare)) {
+            return INFINITE_LOOP;
+        }
+    }
+}
+
+#ifdef HAVE_AVX2_KERNEL
+
+/**
+ * @brief Robots that are currently being simulated, one array per attribute,
+ * so that each attribute of a group of lanes can be loaded into one vector.
+ */
+struct lanes
+{
+    int32_t index[BATCH_LANES] __attribute__((aligned(32)));
+    int32_t col[BATCH_LANES] __attribute__((aligned(32)));
+    int32_t direction[BATCH_LANES] __attribute__((aligned(32)));
+    int32_t tortoise_index[BATCH_LANES] __attribute__((aligned(32)));
+    int32_t tortoise_direction[BATCH_LANES] __attribute__((aligned(32)));
+    uint32_t power[BATCH_LANES] __attribute__((aligned(32)));
+    uint32_t length[BATCH_LANES] __attribute__((aligned(32)));
+    int32_t state[BATCH_LANES] __attribute__((aligned(32)));
+    int32_t alive[BATCH_LANES] __attribute__((aligned(32)));
+    size_t robot[BATCH_LANES];
+};
+
+/**
+ * @brief Puts next robot that has not finished yet into the lane.
+ * @param batch Simulation.
+ * @param lanes Lanes of the simulator.
+ * @param lane Lane to be refilled.
+ * @returns <code>true</code> if the lane holds a robot, <code>false</code> if
+ * there are no robots left.
+ */
+static bool refill(struct batch *batch, struct lanes *lanes, size_t lane)
+{
+    size_t cells = batch->width * batch->height;
+
+    while (batch->next < batch->count) {
+        size_t robot = batch->next++;
+        size_t position = batch->positions[robot];
+
+        if (position >= cells) {
+            batch->results[robot] = OUT_OF_BOUNDS;
+            continue;
+        }
+
+        enum direction_t direction = direction_from_char(batch->directions[robot]);
+        lanes->index[lane] = lanes->tortoise_index[lane] = (int32_t) position;
+        lanes->col[lane] = (int32_t) (position % batch->width);
+        lanes->direction[lane] = lanes->tortoise_direction[lane] = (int32_t) direction;
+        lanes->power[lane] = lanes->length[lane] = 1;
+        lanes->alive[lane] = -1;
+        lanes->robot[lane] = robot;
+        return true;
+    }
+
+    // empty lane is parked in the top left corner and never moves, so that its
+    // gathers stay within the map
+    lanes->index[lane] = lanes->tortoise_index[lane] = 0;
+    lanes->col[lane] = 0;
+    lanes->direction[lane] = lanes->tortoise_direction[lane] = NORTH;
+    lanes->power[lane] = lanes->length[lane] = 1;
+    lanes->alive[lane] = 0;
+    lanes->robot[lane] = NO_ROBOT;
+    return false;
+}
+
+#define LOAD(field) _mm256_load_si256((const __m256i *) &lanes.field[offset])
+#define STORE(field, value) _mm256_store_si256((__m256i *) &lanes.field[offset], (value))
+
+__attribute__((target("avx2"))) static void simulate_avx2(struct batch *batch)
+{
+    struct lanes lanes;
+    uint32_t active = 0;
+    for (size_t lane = 0; lane < BATCH_LANES; lane++) {
+        active |= (uint32_t) refill(batch, &lanes, lane) << lane;
+    }
+
+    // Gathers load 32-bit words starting at the cell, lanes whose word would
+    // reach past the end of the map are masked out and loaded byte by byte.
+    const int *base = (const int *) (const void *) batch->map;
+    const __m256i last_word = _mm256_set1_epi32((int32_t) (batch->width * batch->height) - 4);
+
+    const int32_t width = (int32_t) batch->width;
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i one = _mm256_set1_epi32(1);
+    const __m256i low_byte = _mm256_set1_epi32(0xFF);
+    const __m256i width_v = _mm256_set1_epi32(width);
+    const __m256i last_row = _mm256_set1_epi32((int32_t) (batch->width * batch->height - batch->width) - 1);
+    const __m256i last_col = _mm256_set1_epi32(width - 1);
+    const __m256i deltas = _mm256_setr_epi32(-width, 1, width, -1, 0, 0, 0, 0);
+    const __m256i col_deltas = _mm256_setr_epi32(0, 1, 0, -1, 0, 0, 0, 0);
+
+    while (active != 0) {
+        uint32_t finished = 0;
+        batch->steps += (size_t) __builtin_popcount(active);
+
+        // both groups are independent, unrolling lets their gathers overlap
+#pragma GCC unroll 2
+        for (size_t offset = 0; offset < BATCH_LANES; offset += GROUP_LANES) {
+            __m256i index = LOAD(index);
+            __m256i col = LOAD(col);
+            __m256i direction = LOAD(direction);
+
+            __m256i tail = _mm256_cmpgt_epi32(index, last_word);
+            __m256i word = _mm256_mask_i32gather_epi32(zero, base, index, _mm256_xor_si256(tail, _mm256_cmpeq_epi32(zero, zero)), 1);
+            __m256i cell = _mm256_and_si256(word, low_byte);
+
+            uint32_t tail_lanes = (uint32_t) _mm256_movemask_ps(_mm256_castsi256_ps(tail));
+            if (tail_lanes != 0) {
+                int32_t cells[GROUP_LANES] __attribute__((aligned(32)));
+                _mm256_store_si256((__m256i *) cells, cell);
+                for (; tail_lanes != 0; tail_lanes &= tail_lanes - 1) {
+                    size_t lane = (size_t) __builtin_ctz(tail_lanes);
+                    cells[lane] = (unsigned char) batch->map[lanes.index[offset + lane]];
+                }
+                cell = _mm256_load_si256((const __m256i *) cells);
+            }
+
+            // enter the cell
+            direction = _mm256_blendv_epi8(direction, _mm256_set1_epi32(NORTH), _mm256_cmpeq_epi32(cell, _mm256_set1_epi32('^')));
+            direction = _mm256_blendv_epi8(direction, _mm256_set1_epi32(EAST), _mm256_cmpeq_epi32(cell, _mm256_set1_epi32('>')));
+            direction = _mm256_blendv_epi8(direction, _mm256_set1_epi32(SOUTH), _mm256_cmpeq_epi32(cell, _mm256_set1_epi32('v')));
+            direction = _mm256_blendv_epi8(direction, _mm256_set1_epi32(WEST), _mm256_cmpeq_epi32(cell, _mm256_set1_epi32('<')));
+
+            __m256i out = _mm256_and_si256(_mm256_cmpeq_epi32(direction, _mm256_set1_epi32(NORTH)), _mm256_cmpgt_epi32(width_v, index));
+            out = _mm256_or_si256(out, _mm256_and_si256(_mm256_cmpeq_epi32(direction, _mm256_set1_epi32(SOUTH)), _mm256_cmpgt_epi32(index, last_row)));
+            out = _mm256_or_si256(out, _mm256_and_si256(_mm256_cmpeq_epi32(direction, _mm256_set1_epi32(EAST)), _mm256_cmpeq_epi32(col, last_col)));
+            out = _mm256_or_si256(out, _mm256_and_si256(_mm256_cmpeq_epi32(direction, _mm256_set1_epi32(WEST)), _mm256_cmpeq_epi32(col, zero)));
+
+            __m256i state = _mm256_and_si256(out, _mm256_set1_epi32(OUT_OF_BOUNDS));
+            state = _mm256_blendv_epi8(state, _mm256_set1_epi32(FOUND_KEY), _mm256_cmpeq_epi32(cell, _mm256_set1_epi32('K')));
+            state = _mm256_blendv_epi8(state, _mm256_set1_epi32(FOUND_TREASURE), _mm256_cmpeq_epi32(cell, _mm256_set1_epi32('T')));
+
+            // move the robots that are still walking
+            __m256i walking = _mm256_and_si256(_mm256_cmpeq_epi32(state, zero), LOAD(alive));
+            index = _mm256_blendv_epi8(index, _mm256_add_epi32(index, _mm256_permutevar8x32_epi32(deltas, direction)), walking);
+            col = _mm256_blendv_epi8(col, _mm256_add_epi32(col, _mm256_permutevar8x32_epi32(col_deltas, direction)), walking);
+
+            // Brent's cycle detection
+            __m256i tortoise_index = LOAD(tortoise_index);
+            __m256i tortoise_direction = LOAD(tortoise_direction);
+            __m256i power = LOAD(power);
+            __m256i length = LOAD(length);
+
+            __m256i loop = _mm256_and_si256(walking, _mm256_and_si256(_mm256_cmpeq_epi32(index, tortoise_index), _mm256_cmpeq_epi32(direction, tortoise_direction)));
+            state = _mm256_blendv_epi8(state, _mm256_set1_epi32(INFINITE_LOOP), loop);
+
+            __m256i teleport = _mm256_cmpeq_epi32(power, length);
+            STORE(tortoise_index, _mm256_blendv_epi8(tortoise_index, index, teleport));
+            STORE(tortoise_direction, _mm256_blendv_epi8(tortoise_direction, direction, teleport));
+            STORE(power, _mm256_blendv_epi8(power, _mm256_slli_epi32(power, 1), teleport));
+            STORE(length, _mm256_add_epi32(_mm256_andnot_si256(teleport, length), one));
+
+            STORE(index, index);
+            STORE(col, col);
+            STORE(direction, direction);
+            STORE(state, state);
+
+            uint32_t done = (uint32_t) _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(state, zero)));
+            finished |= (~done & 0xFF) << offset;
+        }
+
+        // retire the robots that have finished and refill their lanes
+        finished &= active;
+        while (finished != 0) {
+            size_t lane = (size_t) __builtin_ctz(finished);
+            finished &= finished - 1;
+
+            batch->results[lanes.robot[lane]] = (enum end_state_t) lanes.state[lane];
+            if (!refill(batch, &lanes, lane)) {
+                active &= ~((uint32_t) 1 << lane);
+            }
+        }
+    }
+}
+
+#undef LOAD
+#undef STORE
+
+#endif
+
+size_t walk_batch_scalar(const char *map,
+        size_t width,
+        size_t height,
+        size_t count,
+        const size_t *positions,
+        const char *directions,
+        enum end_state_t *results)
+{
+    struct batch batch = { map, width, height, count, positions, directions, results, 0, 0 };
+
+    for (size_t robot = 0; robot < count; robot++) {
+        results[robot] = walk_one(&batch, robot);
+    }
+    return batch.steps;
+}
+
+size_t walk_batch(const char *map,
+        size_t width,
+        size_t height,
+        size_t count,
+        const size_t *positions,
+        const char *directions,
+        enum end_state_t *results)
+{
+    size_t cells = width * height;
+
+#ifdef HAVE_AVX2_KERNEL
+    if (cells > 0 && cells <= KERNEL_MAX_CELLS && __builtin_cpu_supports("avx2")) {
+        struct batch batch = { map, width, height, count, positions, directions, results, 0, 0 };
+        simulate_avx2(&batch);
+        return batch.steps;
+    }
+#else
+    (void) cells;
+#endif
+
+    return walk_batch_scalar(map, width, height, count, positions, directions, results);
+}
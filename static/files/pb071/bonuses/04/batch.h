@@ -0,0 +1,53 @@
+#ifndef _BATCH_H
+#define _BATCH_H
+
+#include "maze.h"
+
+#include <stddef.h>
+
+/**
+ * Count of the robots that are simulated at once by the vectorized simulator,
+ * two groups of 8 lanes (AVX2) are advanced in each step, so that the gathers
+ * from both groups are in flight at the same time.
+ */
+#define BATCH_LANES 16
+
+/**
+ * @brief Get end states of multiple robots walking in the same maze.
+ *
+ * Robots are kept in the structure-of-arrays form and advanced in lanes, robot
+ * that finishes its walk is retired and its lane is refilled with the next one.
+ * In case the CPU does not support AVX2 or the map is too big for 32-bit
+ * indices, robots are simulated one by one.
+ *
+ * @param map Map of the maze.
+ * @param width Width of the map.
+ * @param height Height of the map.
+ * @param count Count of the robots.
+ * @param positions Initial positions of the robots as offsets from the start of
+ * the map.
+ * @param directions Initial directions of the robots, each one of "^v<>".
+ * @param results Output array where the end state of each robot is stored.
+ * @returns Count of the steps done by all robots together.
+ */
+size_t walk_batch(const char *map,
+        size_t width,
+        size_t height,
+        size_t count,
+        const size_t *positions,
+        const char *directions,
+        enum end_state_t *results);
+
+/**
+ * @brief Same as <code>walk_batch</code>, but simulates the robots one by one
+ * without any vectorization.
+ */
+size_t walk_batch_scalar(const char *map,
+        size_t width,
+        size_t height,
+        size_t count,
+        const size_t *positions,
+        const char *directions,
+        enum end_state_t *results);
+
+#endif
@@ -0,0 +1,64 @@
+#include "batch.h"
+#include "clock.h"
+#include "generate.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define DEFAULT_SIDE 4096
+#define DEFAULT_ROBOTS 100000
+
+static void report(const char *name, size_t steps, double elapsed, size_t robots)
+{
+    printf("%-10s %14zu %10.3f %16.0f %14.0f\n", name, steps, elapsed, steps / elapsed, robots / elapsed);
+}
+
+int main(int argc, char **argv)
+{
+    size_t side = argc > 1 ? strtoul(argv[1], NULL, 10) : DEFAULT_SIDE;
+    size_t robots = argc > 2 ? strtoul(argv[2], NULL, 10) : DEFAULT_ROBOTS;
+    uint64_t seed = 0x5EED;
+
+    char *map = malloc(side * side);
+    size_t *positions = malloc(robots * sizeof(size_t));
+    char *directions = malloc(robots);
+    enum end_state_t *batched = malloc(robots * sizeof(enum end_state_t));
+    enum end_state_t *scalar = malloc(robots * sizeof(enum end_state_t));
+    if (map == NULL || positions == NULL || directions == NULL || batched == NULL || scalar == NULL) {
+        fprintf(stderr, "Could not allocate the map\n");
+        return 1;
+    }
+
+    char direction;
+    generate_maze(map, side, side, MAZE_RANDOM, &seed, &direction);
+    for (size_t i = 0; i < robots; i++) {
+        positions[i] = next_random(&seed) % (side * side);
+        directions[i] = "^>v<"[next_random(&seed) % 4];
+    }
+
+    printf("%-10s %14s %10s %16s %14s\n", "mode", "robot-steps", "time [s]", "robot-steps/s", "robots/s");
+
+    double start = now_seconds();
+    size_t steps = walk_batch_scalar(map, side, side, robots, positions, directions, scalar);
+    report("scalar", steps, now_seconds() - start, robots);
+
+    start = now_seconds();
+    steps = walk_batch(map, side, side, robots, positions, directions, batched);
+    report("batched", steps, now_seconds() - start, robots);
+
+    size_t mismatches = 0;
+    for (size_t i = 0; i < robots; i++) {
+        mismatches += batched[i] != scalar[i];
+    }
+    if (mismatches != 0) {
+        fprintf(stderr, "%zu robots differ between the modes\n", mismatches);
+    }
+
+    free(scalar);
+    free(batched);
+    free(directions);
+    free(positions);
+    free(map);
+    return mismatches != 0;
+}
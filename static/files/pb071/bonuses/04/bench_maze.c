@@ -0,0 +1,121 @@
+#include "batch.h"
+#include "clock.h"
+#include "generate.h"
+#include "maze.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define MIN_SIDE 16
+#define DEFAULT_MAX_SIDE 1024
+
+/** Walks on each map are limited so that each map takes roughly the same time. */
+#define STEP_BUDGET ((size_t) 1 << 24)
+#define MIN_WALKS 5
+#define MAX_WALKS 2000
+
+static int compare_doubles(const void *left, const void *right)
+{
+    double l = *(const double *) left;
+    double r = *(const double *) right;
+    return (l > r) - (l < r);
+}
+
+/**
+ * @brief Gets the percentile of the sorted latencies, in microseconds.
+ */
+static double percentile(const double *sorted, size_t count, unsigned p)
+{
+    return sorted[(count - 1) * p / 100] * 1e6;
+}
+
+/**
+ * @brief Benchmarks <code>walk</code> on one map, walks start at the entrance
+ * of the structured mazes and at random positions of the random mazes. Number
+ * of the steps of each walk is counted by the scalar simulator, that also
+ * verifies the end state.
+ * @returns Count of the walks with different end states.
+ */
+static size_t bench(char *map, size_t side, enum maze_kind_t kind, uint64_t *seed, double *latencies)
+{
+    char entrance_direction;
+    size_t entrance = generate_maze(map, side, side, kind, seed, &entrance_direction);
+
+    size_t cells = side * side;
+    size_t walks = STEP_BUDGET / cells;
+    walks = walks < MIN_WALKS ? MIN_WALKS : (walks > MAX_WALKS ? MAX_WALKS : walks);
+
+    size_t steps = 0;
+    size_t mismatches = 0;
+    double total = 0;
+
+    for (size_t i = 0; i < walks; i++) {
+        size_t position = entrance;
+        char direction = entrance_direction;
+        if (kind == MAZE_RANDOM) {
+            position = next_random(seed) % cells;
+            direction = "^>v<"[next_random(seed) % 4];
+        }
+
+        double start = now_seconds();
+        enum end_state_t state = walk(map, map + position, direction, side, side);
+        latencies[i] = now_seconds() - start;
+        total += latencies[i];
+
+        enum end_state_t expected;
+        steps += walk_batch_scalar(map, side, side, 1, &position, &direction, &expected);
+        mismatches += state != expected;
+    }
+
+    // walks may be too short for the resolution of the clock
+    double rate = total > 0 ? steps / total : 0;
+
+    qsort(latencies, walks, sizeof(double), compare_doubles);
+    printf("%-10s %6zu %6zu %12.0f %14.0f %10.1f %10.1f %10.1f %10.1f\n",
+            maze_kind_name(kind),
+            side,
+            walks,
+            (double) steps / walks,
+            rate,
+            percentile(latencies, walks, 50),
+            percentile(latencies, walks, 90),
+            percentile(latencies, walks, 99),
+            latencies[walks - 1] * 1e6);
+    return mismatches;
+}
+
+int main(int argc, char **argv)
+{
+    size_t max_side = argc > 1 ? strtoul(argv[1], NULL, 10) : DEFAULT_MAX_SIDE;
+    uint64_t seed = argc > 2 ? strtoull(argv[2], NULL, 10) : 0x5EED;
+    if (max_side < MIN_SIDE || seed == 0) {
+        printf("Usage: %s [max-side (at least %d)] [seed (non-zero)]\n", argv[0], MIN_SIDE);
+        return 1;
+    }
+
+    char *map = malloc(max_side * max_side);
+    double *latencies = malloc(MAX_WALKS * sizeof(double));
+    if (map == NULL || latencies == NULL) {
+        fprintf(stderr, "Could not allocate the map\n");
+        free(map);
+        return 1;
+    }
+
+    printf("%-10s %6s %6s %12s %14s %10s %10s %10s %10s\n",
+            "maze", "side", "walks", "steps/walk", "steps/s", "p50 [us]", "p90 [us]", "p99 [us]", "max [us]");
+
+    size_t mismatches = 0;
+    for (size_t side = MIN_SIDE; side <= max_side; side *= 2) {
+        for (size_t kind = 0; kind < MAZE_KINDS; kind++) {
+            mismatches += bench(map, side, (enum maze_kind_t) kind, &seed, latencies);
+        }
+    }
+    if (mismatches != 0) {
+        fprintf(stderr, "%zu walks differ from the reference simulator\n", mismatches);
+    }
+
+    free(latencies);
+    free(map);
+    return mismatches != 0;
+}
@@ -0,0 +1,81 @@
+#include "batch.h"
+#include "clock.h"
+#include "generate.h"
+#include "packed.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define DEFAULT_SIDE 4096
+#define DEFAULT_WALKS 20000
+
+static void report(const char *name, double memory, double elapsed, size_t walks)
+{
+    printf("%-8s %12.1f %10.3f %14.0f\n", name, memory / (1024 * 1024), elapsed, walks / elapsed);
+}
+
+int main(int argc, char **argv)
+{
+    size_t side = argc > 1 ? strtoul(argv[1], NULL, 10) : DEFAULT_SIDE;
+    size_t walks = argc > 2 ? strtoul(argv[2], NULL, 10) : DEFAULT_WALKS;
+    uint64_t seed = 0x5EED;
+
+    char *map = malloc(side * side);
+    size_t *positions = malloc(walks * sizeof(size_t));
+    char *directions = malloc(walks);
+    enum end_state_t *expected = malloc(walks * sizeof(enum end_state_t));
+    if (map == NULL || positions == NULL || directions == NULL || expected == NULL) {
+        fprintf(stderr, "Could not allocate the map\n");
+        return 1;
+    }
+
+    char direction;
+    generate_maze(map, side, side, MAZE_RANDOM, &seed, &direction);
+    for (size_t i = 0; i < walks; i++) {
+        size_t row = next_random(&seed) % side;
+        size_t col = next_random(&seed) % side;
+        positions[i] = row * side + col;
+        directions[i] = "^>v<"[next_random(&seed) % 4];
+    }
+
+    printf("%-8s %12s %10s %14s\n", "layout", "memory [MiB]", "time [s]", "walks/s");
+
+    // scalar batch walks the byte map with the same algorithm as the packed
+    // walk, so that only the representation of the map differs
+    double start = now_seconds();
+    walk_batch_scalar(map, side, side, walks, positions, directions, expected);
+    report("byte", (double) side * side, now_seconds() - start, walks);
+
+    const char *names[] = { "rows", "tiled" };
+    const enum packed_layout_t layouts[] = { LAYOUT_ROWS, LAYOUT_TILED };
+    int result = 0;
+
+    for (size_t l = 0; l < 2; l++) {
+        struct packed_maze maze;
+        if (!packed_maze_init(&maze, map, side, side, layouts[l])) {
+            fprintf(stderr, "Could not encode the map\n");
+            result = 1;
+            break;
+        }
+
+        size_t mismatches = 0;
+        start = now_seconds();
+        for (size_t i = 0; i < walks; i++) {
+            mismatches += packed_walk(&maze, positions[i] / side, positions[i] % side, directions[i]) != expected[i];
+        }
+        report(names[l], (double) side * side / 2, now_seconds() - start, walks);
+
+        if (mismatches != 0) {
+            fprintf(stderr, "%zu walks differ from the byte map\n", mismatches);
+            result = 1;
+        }
+        packed_maze_destroy(&maze);
+    }
+
+    free(expected);
+    free(directions);
+    free(positions);
+    free(map);
+    return result;
+}
@@ -0,0 +1,593 @@
+#include "cache.h"
+
+#include "cell.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+/** Marks states on the path that is being resolved. */
+#define ON_PATH 0xFF
+
+#define INITIAL_QUEUE 64
+
+static size_t state_of(size_t cell, enum direction_t direction)
+{
+    return 4 * cell + direction;
+}
+
+/**
+ * @brief Finds the state that follows the given one.
+ * @param cache Cache of the maze.
+ * @param state Current state of the robot.
+ * @param next Output variable where the following state is set.
+ * @returns <code>NONE</code> if the robot continues walking, end state otherwise.
+ */
+static enum end_state_t next_state(const struct maze_cache *cache, size_t state, size_t *next)
+{
+    size_t cell = state / 4;
+    struct robot robot = { cell / cache->width, cell % cache->width, (enum direction_t) (state % 4) };
+
+    enum end_state_t end = enter_cell(cell_from_char(cache->map[cell]), &robot.direction);
+    if (end != NONE) {
+        return end;
+    }
+    if (!move_robot(&robot, cache->width, cache->height)) {
+        return OUT_OF_BOUNDS;
+    }
+
+    *next = state_of(robot.row * cache->width + robot.col, robot.direction);
+    return NONE;
+}
+
+/**
+ * @brief Finds the states that lead to the given one. Predecessors are not
+ * stored, since they can be derived from the neighbouring cell.
+ * @param cache Cache of the maze.
+ * @param state State of the robot.
+ * @param predecessors Output array where the predecessors are stored.
+ * @returns Count of the predecessors.
+ */
+static size_t find_predecessors(const struct maze_cache *cache, size_t state, size_t predecessors[4])
+{
+    size_t cell = state / 4;
+    enum direction_t direction = (enum direction_t) (state % 4);
+
+    // robot had to come from the cell behind it
+    struct robot robot = { cell / cache->width, cell % cache->width, (enum direction_t) ((direction + 2) % 4) };
+    if (!move_robot(&robot, cache->width, cache->height)) {
+        return 0;
+    }
+
+    size_t from = robot.row * cache->width + robot.col;
+    enum cell_t kind = cell_from_char(cache->map[from]);
+
+    if (kind == CELL_EMPTY) {
+        predecessors[0] = state_of(from, direction);
+        return 1;
+    }
+    if (kind == (enum cell_t) (CELL_NORTH + direction)) {
+        for (size_t i = 0; i < 4; i++) {
+            predecessors[i] = state_of(from, (enum direction_t) i);
+        }
+        return 4;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Resolves end state of the given state and all unresolved states on its
+ * path. Path is followed twice, first time to find the end state, second time
+ * to store it, so that no additional memory is needed.
+ * @param cache Cache of the maze.
+ * @param start State to be resolved.
+ */
+static void solve(struct maze_cache *cache, size_t start)
+{
+    enum end_state_t end = NONE;
+    size_t state = start;
+
+    while (end == NONE) {
+        unsigned char known = cache->outcomes[state];
+        if (known == ON_PATH) {
+            end = INFINITE_LOOP;
+        } else if (known != NONE) {
+            end = (enum end_state_t) known;
+        } else {
+            cache->outcomes[state] = ON_PATH;
+            end = next_state(cache, state, &state);
+        }
+    }
+
+    state = start;
+    while (cache->outcomes[state] == ON_PATH) {
+        cache->outcomes[state] = (unsigned char) end;
+        if (next_state(cache, state, &state) != NONE) {
+            break;
+        }
+    }
+}
+
+bool maze_cache_init(struct maze_cache *cache, char *map, size_t width, size_t height)
+{
+    cache->map = map;
+    cache->width = width;
+    cache->height = height;
+
+    size_t states = 4 * width * height;
+    if (height != 0 && states / 4 / height != width) {
+        return false;
+    }
+
+    cache->outcomes = calloc(states, 1);
+    if (cache->outcomes == NULL) {
+        return false;
+    }
+
+    for (size_t state = 0; state < states; state++) {
+        if (cache->outcomes[state] == NONE) {
+            solve(cache, state);
+        }
+    }
+
+    return true;
+}
+
+/*
+ * Parallel precomputation
+ *
+ * Values of the states within a tile are either global states where the walk
+ * leaves the tile, or encoded end states of the walks.
+ */
+#define UNRESOLVED SIZE_MAX
+#define TILE_ON_PATH (SIZE_MAX - 1)
+#define TERMINAL(end) (SIZE_MAX - 8 + (size_t) (end))
+#define IS_TERMINAL(value) ((value) >= SIZE_MAX - 8)
+
+/**
+ * @brief Shared state of the parallel precomputation.
+ */
+struct tiling
+{
+    struct maze_cache *cache;
+    size_t side;
+    size_t tiles_per_row;
+    size_t tiles;
+
+    /** Value of each state where the robot enters a tile, indexed by slots. */
+    size_t *entries;
+    /** End state of the walk from each state where the robot enters a tile. */
+    unsigned char *entry_outcomes;
+
+    atomic_size_t next_tile;
+};
+
+/**
+ * @brief Bounds of the tile within the map.
+ */
+struct tile
+{
+    size_t first_row;
+    size_t first_col;
+    size_t rows;
+    size_t cols;
+};
+
+static struct tile tile_bounds(const struct tiling *tiling, size_t index)
+{
+    struct tile tile;
+    tile.first_row = (index / tiling->tiles_per_row) * tiling->side;
+    tile.first_col = (index % tiling->tiles_per_row) * tiling->side;
+    tile.rows = tiling->cache->height - tile.first_row < tiling->side ? tiling->cache->height - tile.first_row : tiling->side;
+    tile.cols = tiling->cache->width - tile.first_col < tiling->side ? tiling->cache->width - tile.first_col : tiling->side;
+    return tile;
+}
+
+/**
+ * @brief Finds the slot of the state where the robot enters a tile. Slots are
+ * grouped by tiles and then by the direction of the robot, i.e. by the side of
+ * the tile it entered through.
+ */
+static size_t slot_of(const struct tiling *tiling, size_t state)
+{
+    size_t cell = state / 4;
+    enum direction_t direction = (enum direction_t) (state % 4);
+    size_t row = cell / tiling->cache->width;
+    size_t col = cell % tiling->cache->width;
+
+    size_t tile = (row / tiling->side) * tiling->tiles_per_row + col / tiling->side;
+    size_t offset = (direction == NORTH || direction == SOUTH) ? col % tiling->side : row % tiling->side;
+    return (4 * tile + direction) * tiling->side + offset;
+}
+
+/**
+ * @brief Finds the state where the robot enters the tile through given slot.
+ * @returns <code>true</code> if the slot is used, <code>false</code> if the
+ * robot cannot enter the tile there.
+ */
+static bool slot_state(const struct tiling *tiling, const struct tile *tile, enum direction_t direction, size_t offset, size_t *state)
+{
+    const struct maze_cache *cache = tiling->cache;
+    size_t row = tile->first_row + offset;
+    size_t col = tile->first_col + offset;
+    bool used = false;
+
+    switch (direction) {
+    case SOUTH:
+        row = tile->first_row;
+        used = row > 0 && offset < tile->cols;
+        break;
+    case NORTH:
+        row = tile->first_row + tile->rows - 1;
+        used = row + 1 < cache->height && offset < tile->cols;
+        break;
+    case EAST:
+        col = tile->first_col;
+        used = col > 0 && offset < tile->rows;
+        break;
+    case WEST:
+        col = tile->first_col + tile->cols - 1;
+        used = col + 1 < cache->width && offset < tile->rows;
+        break;
+    }
+
+    *state = state_of(row * cache->width + col, direction);
+    return used;
+}
+
+/**
+ * @brief Does one step of the robot within the tile.
+ * @param tiling Precomputation.
+ * @param tile Tile the robot is in.
+ * @param local State of the robot local to the tile.
+ * @param next Output variable where the following local state is set.
+ * @returns <code>UNRESOLVED</code> if the robot stays within the tile, global
+ * state if it leaves the tile, or encoded end state of the walk.
+ */
+static size_t tile_step(const struct tiling *tiling, const struct tile *tile, size_t local, size_t *next)
+{
+    const struct maze_cache *cache = tiling->cache;
+    size_t cell = local / 4;
+    struct robot robot = { tile->first_row + cell / tile->cols, tile->first_col + cell % tile->cols, (enum direction_t) (local % 4) };
+
+    enum end_state_t end = enter_cell(cell_from_char(cache->map[robot.row * cache->width + robot.col]), &robot.direction);
+    if (end != NONE) {
+        return TERMINAL(end);
+    }
+    if (!move_robot(&robot, cache->width, cache->height)) {
+        return TERMINAL(OUT_OF_BOUNDS);
+    }
+
+    // unsigned arithmetic wraps around for the preceding tiles
+    size_t row = robot.row - tile->first_row;
+    size_t col = robot.col - tile->first_col;
+    if (row >= tile->rows || col >= tile->cols) {
+        return state_of(robot.row * cache->width + robot.col, robot.direction);
+    }
+
+    *next = 4 * (row * tile->cols + col) + robot.direction;
+    return UNRESOLVED;
+}
+
+/**
+ * @brief Resolves all states of the tile up to the point where the robot leaves
+ * the tile, same way as <code>solve</code> does for the whole map.
+ * @param tiling Precomputation.
+ * @param tile Tile to be resolved.
+ * @param values Values of the states within the tile, indexed by the local
+ * states.
+ */
+static void resolve_tile(const struct tiling *tiling, const struct tile *tile, size_t *values)
+{
+    size_t states = 4 * tile->rows * tile->cols;
+
+    for (size_t i = 0; i < states; i++) {
+        values[i] = UNRESOLVED;
+    }
+
+    for (size_t start = 0; start < states; start++) {
+        if (values[start] != UNRESOLVED) {
+            continue;
+        }
+
+        size_t result = UNRESOLVED;
+        size_t local = start;
+        while (result == UNRESOLVED) {
+            if (values[local] == TILE_ON_PATH) {
+                result = TERMINAL(INFINITE_LOOP);
+            } else if (values[local] != UNRESOLVED) {
+                result = values[local];
+            } else {
+                values[local] = TILE_ON_PATH;
+                result = tile_step(tiling, tile, local, &local);
+            }
+        }
+
+        local = start;
+        while (values[local] == TILE_ON_PATH) {
+            values[local] = result;
+            if (tile_step(tiling, tile, local, &local) != UNRESOLVED) {
+                break;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Worker of the first phase, resolves tiles and stores values of the
+ * states where the robot enters them.
+ */
+static void *summarize_tiles(void *arg)
+{
+    struct tiling *tiling = arg;
+    size_t *values = malloc(4 * tiling->side * tiling->side * sizeof(size_t));
+    if (values == NULL) {
+        return arg;
+    }
+
+    size_t index;
+    while ((index = atomic_fetch_add(&tiling->next_tile, 1)) < tiling->tiles) {
+        struct tile tile = tile_bounds(tiling, index);
+        resolve_tile(tiling, &tile, values);
+
+        for (size_t direction = 0; direction < 4; direction++) {
+            for (size_t offset = 0; offset < tiling->side; offset++) {
+                size_t state;
+                if (!slot_state(tiling, &tile, (enum direction_t) direction, offset, &state)) {
+                    continue;
+                }
+
+                size_t row = state / 4 / tiling->cache->width - tile.first_row;
+                size_t col = state / 4 % tiling->cache->width - tile.first_col;
+                tiling->entries[(4 * index + direction) * tiling->side + offset] = values[4 * (row * tile.cols + col) + direction];
+            }
+        }
+    }
+
+    free(values);
+    return NULL;
+}
+
+/**
+ * @brief Resolves end state of the walk from the entry slot and all entries on
+ * its path, loops spanning multiple tiles are found here.
+ */
+static void stitch(struct tiling *tiling, size_t start)
+{
+    unsigned char *outcomes = tiling->entry_outcomes;
+    enum end_state_t end = NONE;
+    size_t slot = start;
+
+    while (end == NONE) {
+        if (outcomes[slot] == ON_PATH) {
+            end = INFINITE_LOOP;
+        } else if (outcomes[slot] != NONE) {
+            end = (enum end_state_t) outcomes[slot];
+        } else {
+            outcomes[slot] = ON_PATH;
+
+            size_t value = tiling->entries[slot];
+            if (IS_TERMINAL(value)) {
+                end = (enum end_state_t) (value - TERMINAL(NONE));
+            } else {
+                slot = slot_of(tiling, value);
+            }
+        }
+    }
+
+    slot = start;
+    while (outcomes[slot] == ON_PATH) {
+        outcomes[slot] = (unsigned char) end;
+
+        size_t value = tiling->entries[slot];
+        if (IS_TERMINAL(value)) {
+            break;
+        }
+        slot = slot_of(tiling, value);
+    }
+}
+
+/**
+ * @brief Worker of the last phase, resolves tiles once more and fills in end
+ * states of the walks that leave the tile from the stitched entries.
+ */
+static void *fill_tiles(void *arg)
+{
+    struct tiling *tiling = arg;
+    struct maze_cache *cache = tiling->cache;
+    size_t *values = malloc(4 * tiling->side * tiling->side * sizeof(size_t));
+    if (values == NULL) {
+        return arg;
+    }
+
+    size_t index;
+    while ((index = atomic_fetch_add(&tiling->next_tile, 1)) < tiling->tiles) {
+        struct tile tile = tile_bounds(tiling, index);
+        resolve_tile(tiling, &tile, values);
+
+        for (size_t row = 0; row < tile.rows; row++) {
+            for (size_t col = 0; col < tile.cols; col++) {
+                size_t cell = (tile.first_row + row) * cache->width + tile.first_col + col;
+
+                for (size_t direction = 0; direction < 4; direction++) {
+                    size_t value = values[4 * (row * tile.cols + col) + direction];
+                    cache->outcomes[4 * cell + direction] = IS_TERMINAL(value)
+                            ? (unsigned char) (value - TERMINAL(NONE))
+                            : tiling->entry_outcomes[slot_of(tiling, value)];
+                }
+            }
+        }
+    }
+
+    free(values);
+    return NULL;
+}
+
+/**
+ * @brief Runs the worker on the given count of threads and waits for them.
+ * @returns <code>true</code> if all workers have succeeded, <code>false</code>
+ * otherwise.
+ */
+static bool run_workers(struct tiling *tiling, size_t threads, void *(*worker)(void *))
+{
+    pthread_t *handles = malloc(threads * sizeof(pthread_t));
+    if (handles == NULL) {
+        return false;
+    }
+
+    atomic_store(&tiling->next_tile, 0);
+
+    // in case some thread cannot be started, the others do its work
+    size_t started = 0;
+    while (started < threads && pthread_create(&handles[started], NULL, worker, tiling) == 0) {
+        started++;
+    }
+
+    bool success = started > 0;
+    for (size_t i = 0; i < started; i++) {
+        void *result;
+        pthread_join(handles[i], &result);
+        success = success && result == NULL;
+    }
+
+    free(handles);
+    return success;
+}
+
+bool maze_cache_init_parallel(struct maze_cache *cache, char *map, size_t width, size_t height, size_t threads, size_t tile_side)
+{
+    cache->map = map;
+    cache->width = width;
+    cache->height = height;
+
+    size_t states = 4 * width * height;
+    if (height != 0 && states / 4 / height != width) {
+        return false;
+    }
+
+    if (threads == 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = online > 0 ? (size_t) online : 1;
+    }
+
+    struct tiling tiling;
+    tiling.cache = cache;
+    tiling.side = tile_side != 0 ? tile_side : CACHE_TILE_SIDE;
+    tiling.tiles_per_row = (width + tiling.side - 1) / tiling.side;
+    tiling.tiles = tiling.tiles_per_row * ((height + tiling.side - 1) / tiling.side);
+
+    if (threads > tiling.tiles) {
+        threads = tiling.tiles > 0 ? tiling.tiles : 1;
+    }
+
+    size_t slots = 4 * tiling.tiles * tiling.side;
+    cache->outcomes = malloc(states + 1);
+    tiling.entries = malloc((slots + 1) * sizeof(size_t));
+    tiling.entry_outcomes = calloc(slots + 1, 1);
+
+    bool success = cache->outcomes != NULL && tiling.entries != NULL && tiling.entry_outcomes != NULL
+            && run_workers(&tiling, threads, summarize_tiles);
+
+    if (success) {
+        for (size_t index = 0; index < tiling.tiles; index++) {
+            struct tile tile = tile_bounds(&tiling, index);
+
+            for (size_t direction = 0; direction < 4; direction++) {
+                for (size_t offset = 0; offset < tiling.side; offset++) {
+                    size_t state;
+                    size_t slot = (4 * index + direction) * tiling.side + offset;
+                    if (slot_state(&tiling, &tile, (enum direction_t) direction, offset, &state)
+                            && tiling.entry_outcomes[slot] == NONE) {
+                        stitch(&tiling, slot);
+                    }
+                }
+            }
+        }
+
+        success = run_workers(&tiling, threads, fill_tiles);
+    }
+
+    free(tiling.entry_outcomes);
+    free(tiling.entries);
+    if (!success) {
+        free(cache->outcomes);
+        cache->outcomes = NULL;
+    }
+    return success;
+}
+
+void maze_cache_destroy(struct maze_cache *cache)
+{
+    free(cache->outcomes);
+    cache->outcomes = NULL;
+}
+
+enum end_state_t maze_cache_walk(const struct maze_cache *cache, size_t row, size_t col, char direction)
+{
+    if (row >= cache->height || col >= cache->width) {
+        return OUT_OF_BOUNDS;
+    }
+
+    return (enum end_state_t) cache->outcomes[state_of(row * cache->width + col, direction_from_char(direction))];
+}
+
+size_t maze_cache_update(struct maze_cache *cache, size_t row, size_t col, char cell)
+{
+    size_t changed = row * cache->width + col;
+    size_t capacity = INITIAL_QUEUE;
+    size_t count = 0;
+    bool failed = false;
+
+    size_t *queue = malloc(capacity * sizeof(size_t));
+    if (queue == NULL) {
+        return (size_t) -1;
+    }
+
+    // invalidate all states whose path passes through the changed cell, cache
+    // holds no unresolved states, so NONE also marks the visited ones
+    for (size_t i = 0; i < 4; i++) {
+        queue[count] = state_of(changed, (enum direction_t) i);
+        cache->outcomes[queue[count++]] = NONE;
+    }
+
+    for (size_t i = 0; i < count && !failed; i++) {
+        size_t predecessors[4];
+        size_t found = find_predecessors(cache, queue[i], predecessors);
+
+        for (size_t j = 0; j < found; j++) {
+            if (cache->outcomes[predecessors[j]] == NONE) {
+                continue;
+            }
+
+            if (count == capacity) {
+                size_t *bigger = realloc(queue, 2 * capacity * sizeof(size_t));
+                if (bigger == NULL) {
+                    failed = true;
+                    break;
+                }
+                queue = bigger;
+                capacity *= 2;
+            }
+
+            cache->outcomes[predecessors[j]] = NONE;
+            queue[count++] = predecessors[j];
+        }
+    }
+
+    // in case of failure invalidated states are resolved again on the old map
+    if (!failed) {
+        cache->map[changed] = cell;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        if (cache->outcomes[queue[i]] == NONE) {
+            solve(cache, queue[i]);
+        }
+    }
+
+    free(queue);
+    return failed ? (size_t) -1 : count;
+}
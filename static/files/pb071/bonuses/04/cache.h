@@ -0,0 +1,92 @@
+#ifndef _CACHE_H
+#define _CACHE_H
+
+#include "maze.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @brief Maze with precomputed end states of the walks from every cell in every
+ * direction.
+ *
+ * State of the robot is given by the cell it stands on and the direction it
+ * faces, each state leads to exactly one other state or ends the walk, so the
+ * end states of all walks can be computed in time linear to the size of the map.
+ */
+struct maze_cache
+{
+    char *map;
+    size_t width;
+    size_t height;
+    /** End state for each state of the robot, indexed by 4 * cell + direction. */
+    unsigned char *outcomes;
+};
+
+/**
+ * @brief Computes end states of all walks in the maze.
+ * @param cache Cache to be initialized.
+ * @param map Map of the maze, it is not copied and cells are changed in place
+ * by <code>maze_cache_update</code>.
+ * @param width Width of the map.
+ * @param height Height of the map.
+ * @returns <code>true</code> if the cache has been initialized, <code>false
+ * </code> if the memory could not be allocated.
+ */
+bool maze_cache_init(struct maze_cache *cache, char *map, size_t width, size_t height);
+
+/**
+ * Default side of the tiles used by <code>maze_cache_init_parallel</code>.
+ */
+#define CACHE_TILE_SIDE 256
+
+/**
+ * @brief Computes end states of all walks in the maze in parallel, results are
+ * the same as the ones computed by <code>maze_cache_init</code>.
+ *
+ * Map is split into tiles; walks within each tile are resolved in parallel up
+ * to the point where they leave the tile. States where the robot enters a tile
+ * are then stitched together (loops spanning multiple tiles are detected
+ * there) and finally end states within the tiles are filled in parallel.
+ *
+ * @param cache Cache to be initialized.
+ * @param map Map of the maze, it is not copied.
+ * @param width Width of the map.
+ * @param height Height of the map.
+ * @param threads Count of the threads, 0 to use all online processors.
+ * @param tile_side Side of the tile, 0 to use <code>CACHE_TILE_SIDE</code>.
+ * @returns <code>true</code> if the cache has been initialized, <code>false
+ * </code> if the memory could not be allocated or threads could not be created.
+ */
+bool maze_cache_init_parallel(struct maze_cache *cache, char *map, size_t width, size_t height, size_t threads, size_t tile_side);
+
+/**
+ * @brief Frees the memory held by the cache, map is left untouched.
+ * @param cache Cache to be destroyed.
+ */
+void maze_cache_destroy(struct maze_cache *cache);
+
+/**
+ * @brief Get end state of the robot after his walk, in constant time.
+ * @param cache Cache of the maze.
+ * @param row Initial row of the robot.
+ * @param col Initial column of the robot.
+ * @param direction Direction the robot is facing at the beginning, one of "^v<>".
+ * @returns End state of the robot after his walk.
+ */
+enum end_state_t maze_cache_walk(const struct maze_cache *cache, size_t row, size_t col, char direction);
+
+/**
+ * @brief Changes one cell of the map and recomputes end states of the walks
+ * that pass through the changed cell, other walks are left untouched.
+ * @param cache Cache of the maze.
+ * @param row Row of the changed cell, must be within the map.
+ * @param col Column of the changed cell, must be within the map.
+ * @param cell New character of the cell.
+ * @returns Count of the recomputed states, or <code>(size_t) -1</code> if the
+ * memory could not be allocated (cache is left consistent with the old map in
+ * that case).
+ */
+size_t maze_cache_update(struct maze_cache *cache, size_t row, size_t col, char cell);
+
+#endif
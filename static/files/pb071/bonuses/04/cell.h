@@ -0,0 +1,202 @@
+#ifndef _CELL_H
+#define _CELL_H
+
+#include "maze.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * Kinds of the cells that can be found in the map. Arrows are ordered in the
+ * same way as directions, so that <code>CELL_NORTH + direction</code> gives the
+ * arrow pointing in that direction.
+ */
+enum cell_t
+{
+    CELL_EMPTY,
+    CELL_NORTH,
+    CELL_EAST,
+    CELL_SOUTH,
+    CELL_WEST,
+    CELL_KEY,
+    CELL_TREASURE,
+};
+
+enum direction_t
+{
+    NORTH,
+    EAST,
+    SOUTH,
+    WEST,
+};
+
+/**
+ * @brief State of the robot that is walking through the maze.
+ */
+struct robot
+{
+    size_t row;
+    size_t col;
+    enum direction_t direction;
+};
+
+/**
+ * @brief Converts direction as used by the <code>walk</code> to the enumeration.
+ * @param direction One of "^>v<".
+ * @returns Corresponding direction, north in case of invalid character.
+ */
+static inline enum direction_t direction_from_char(char direction)
+{
+    switch (direction) {
+    case '>':
+        return EAST;
+    case 'v':
+        return SOUTH;
+    case '<':
+        return WEST;
+    default:
+        return NORTH;
+    }
+}
+
+/**
+ * @brief Converts character from the map to the kind of the cell.
+ * @param c Character from the map.
+ * @returns Kind of the cell, unknown characters are treated as empty cells.
+ */
+static inline enum cell_t cell_from_char(char c)
+{
+    switch (c) {
+    case '^':
+        return CELL_NORTH;
+    case '>':
+        return CELL_EAST;
+    case 'v':
+        return CELL_SOUTH;
+    case '<':
+        return CELL_WEST;
+    case 'K':
+        return CELL_KEY;
+    case 'T':
+        return CELL_TREASURE;
+    default:
+        return CELL_EMPTY;
+    }
+}
+
+/**
+ * @brief Converts kind of the cell back to the character used in the map.
+ * @param cell Kind of the cell.
+ * @returns Character representing the cell.
+ */
+static inline char cell_to_char(enum cell_t cell)
+{
+    return ".^>v<KT"[cell];
+}
+
+/**
+ * @brief Lets the robot enter the cell it stands on.
+ * @param cell Kind of the cell the robot stands on.
+ * @param direction Direction of the robot, updated in case of an arrow.
+ * @returns <code>NONE</code> if the robot continues walking, end state otherwise.
+ */
+static inline enum end_state_t enter_cell(enum cell_t cell, enum direction_t *direction)
+{
+    switch (cell) {
+    case CELL_KEY:
+        return FOUND_KEY;
+    case CELL_TREASURE:
+        return FOUND_TREASURE;
+    case CELL_EMPTY:
+        return NONE;
+    default:
+        *direction = (enum direction_t) (cell - CELL_NORTH);
+        return NONE;
+    }
+}
+
+/**
+ * @brief Moves the robot by one cell in the direction it is facing.
+ * @param robot Robot to be moved.
+ * @param width Width of the map.
+ * @param height Height of the map.
+ * @returns <code>true</code> if the robot stays within the map, <code>false
+ * </code> if it fell off (in that case the robot is left untouched).
+ */
+static inline bool move_robot(struct robot *robot, size_t width, size_t height)
+{
+    switch (robot->direction) {
+    case NORTH:
+        if (robot->row == 0) {
+            return false;
+        }
+        robot->row--;
+        return true;
+    case EAST:
+        if (robot->col + 1 >= width) {
+            return false;
+        }
+        robot->col++;
+        return true;
+    case SOUTH:
+        if (robot->row + 1 >= height) {
+            return false;
+        }
+        robot->row++;
+        return true;
+    case WEST:
+        if (robot->col == 0) {
+            return false;
+        }
+        robot->col--;
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * @brief Compares states of two robots.
+ * @returns <code>true</code> if both robots are at the same cell facing the
+ * same direction, <code>false</code> otherwise.
+ */
+static inline bool robot_equal(const struct robot *lhs, const struct robot *rhs)
+{
+    return lhs->row == rhs->row && lhs->col == rhs->col && lhs->direction == rhs->direction;
+}
+
+/**
+ * @brief Brent's cycle detection, so that no memory is needed for the visited
+ * cells; tortoise teleports to the hare every power of two steps. Initialize
+ * with <code>{ start, 1, 1 }</code>.
+ */
+struct cycle_detector
+{
+    struct robot tortoise;
+    size_t power;
+    size_t length;
+};
+
+/**
+ * @brief Checks the robot after it has made a step.
+ * @param detector State of the detection.
+ * @param hare Robot that is walking through the maze.
+ * @returns <code>true</code> if the robot has returned to the state it has
+ * already been in, so it walks in a loop, <code>false</code> otherwise.
+ */
+static inline bool cycle_detected(struct cycle_detector *detector, const struct robot *hare)
+{
+    if (robot_equal(&detector->tortoise, hare)) {
+        return true;
+    }
+
+    if (detector->power == detector->length) {
+        detector->tortoise = *hare;
+        detector->power *= 2;
+        detector->length = 0;
+    }
+    detector->length++;
+    return false;
+}
+
+#endif
@@ -0,0 +1,17 @@
+#ifndef _CLOCK_H
+#define _CLOCK_H
+
+#include <time.h>
+
+/**
+ * @brief Returns current time of the monotonic clock.
+ * @returns Time in seconds.
+ */
+static inline double now_seconds(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double) now.tv_sec + (double) now.tv_nsec / 1e9;
+}
+
+#endif
@@ -0,0 +1,185 @@
+#include "generate.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+/**
+ * @brief Draws the path in the map by moving from cell to cell.
+ */
+struct pen
+{
+    char *map;
+    size_t width;
+    size_t row;
+    size_t col;
+    /** Direction of the previous move. */
+    char last;
+    /** If set, arrows are drawn only where the path turns. */
+    bool sparse;
+};
+
+/**
+ * @brief Moves the pen in the given direction, each cell it leaves gets an arrow
+ * pointing in that direction.
+ * @param pen Pen to be moved.
+ * @param arrow Direction of the move, one of "^v<>".
+ * @param steps Count of the moves.
+ */
+static void pen_move(struct pen *pen, char arrow, size_t steps)
+{
+    for (size_t i = 0; i < steps; i++) {
+        pen->map[pen->row * pen->width + pen->col] = (pen->sparse && arrow == pen->last) ? '.' : arrow;
+        pen->last = arrow;
+
+        switch (arrow) {
+        case '^':
+            pen->row--;
+            break;
+        case 'v':
+            pen->row++;
+            break;
+        case '<':
+            pen->col--;
+            break;
+        case '>':
+            pen->col++;
+            break;
+        }
+    }
+}
+
+/**
+ * @brief Draws a snake through the rows, starting in the top left corner,
+ * rows alternate direction.
+ * @returns Direction of the last row.
+ */
+static char draw_snake(struct pen *pen, size_t rows)
+{
+    char arrow = '>';
+    for (size_t row = 0; row < rows; row++) {
+        arrow = (row % 2 == 0) ? '>' : '<';
+        pen_move(pen, arrow, pen->width - 1);
+        if (row + 1 < rows) {
+            pen_move(pen, 'v', 1);
+        }
+    }
+    return arrow;
+}
+
+/**
+ * @brief Draws a cycle through the rows, starting in the top left corner. Top
+ * row leads to the right, the rest of the rows (except the first column) is
+ * covered by a snake, first column leads back to the top.
+ * @param pen Pen placed in the top left corner of the cycle.
+ * @param rows Count of the rows, must be even.
+ */
+static void draw_cycle(struct pen *pen, size_t rows)
+{
+    pen_move(pen, '>', pen->width - 1);
+    for (size_t row = 1; row < rows; row++) {
+        pen_move(pen, 'v', 1);
+        pen_move(pen, (row % 2 == 1) ? '<' : '>', pen->width - 2);
+    }
+    pen_move(pen, '<', 1);
+    pen_move(pen, '^', rows - 1);
+}
+
+static void fill_random(char *map, size_t cells, uint64_t *seed)
+{
+    for (size_t i = 0; i < cells; i++) {
+        uint64_t r = next_random(seed) % 10000;
+        if (r < 100) {
+            map[i] = "^>v<"[r % 4];
+        } else if (r < 102) {
+            map[i] = (r == 100) ? 'K' : 'T';
+        } else {
+            map[i] = '.';
+        }
+    }
+}
+
+uint64_t next_random(uint64_t *state)
+{
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return *state * 0x2545F4914F6CDD1DULL;
+}
+
+const char *maze_kind_name(enum maze_kind_t kind)
+{
+    static const char *names[] = { "random", "spiral", "long-cycle", "long-tail", "worst-case" };
+    return names[kind];
+}
+
+size_t generate_maze(char *map, size_t width, size_t height, enum maze_kind_t kind, uint64_t *seed, char *direction)
+{
+    size_t cells = width * height;
+    struct pen pen = { map, width, 0, 0, '\0', false };
+    *direction = '>';
+
+    if (kind == MAZE_RANDOM) {
+        fill_random(map, cells, seed);
+        *direction = "^>v<"[next_random(seed) % 4];
+        return cells > 0 ? next_random(seed) % cells : 0;
+    }
+
+    memset(map, '.', cells);
+    if (width < 3 || height < 2) {
+        // too small for any of the paths
+        return 0;
+    }
+
+    switch (kind) {
+    case MAZE_SPIRAL: {
+        size_t top = 0, bottom = height - 1, left = 0, right = width - 1;
+        pen.sparse = true;
+
+        while (top <= bottom && left <= right) {
+            pen_move(&pen, '>', right - pen.col);
+            if (++top > bottom) {
+                break;
+            }
+            pen_move(&pen, 'v', bottom - pen.row);
+            if (left > --right) {
+                break;
+            }
+            pen_move(&pen, '<', pen.col - left);
+            if (top > --bottom) {
+                break;
+            }
+            pen_move(&pen, '^', pen.row - top);
+            left++;
+            pen_move(&pen, '>', 1);
+        }
+        map[pen.row * width + pen.col] = 'T';
+        break;
+    }
+    case MAZE_LONG_CYCLE:
+        draw_cycle(&pen, height - height % 2);
+        break;
+    case MAZE_LONG_TAIL: {
+        char last = draw_snake(&pen, height);
+        // last two cells point to each other
+        map[pen.row * width + pen.col] = (last == '>') ? '<' : '>';
+        break;
+    }
+    case MAZE_WORST_CASE: {
+        size_t tail = (height / 2) - (height / 2) % 2;
+        size_t cycle = (height - tail) - (height - tail) % 2;
+        pen.sparse = true;
+
+        if (tail > 0) {
+            // even count of rows ends in the first column, right above the cycle
+            draw_snake(&pen, tail);
+            pen_move(&pen, 'v', 1);
+        }
+        draw_cycle(&pen, cycle);
+        break;
+    }
+    default:
+        break;
+    }
+
+    return 0;
+}
@@ -0,0 +1,54 @@
+#ifndef _GENERATE_H
+#define _GENERATE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+enum maze_kind_t
+{
+    /** Mostly empty cells with sparse arrows, keys and treasures, robots travel
+     * long distances in all directions. */
+    MAZE_RANDOM,
+    /** Spiral leading from the top left corner to the treasure in the middle,
+     * walk from the entrance visits every cell. */
+    MAZE_SPIRAL,
+    /** Single cycle that passes through every cell (of even count of rows). */
+    MAZE_LONG_CYCLE,
+    /** Path that passes through every cell and ends in a cycle of two cells. */
+    MAZE_LONG_TAIL,
+    /** Path through the upper half of the map that ends in a cycle through the
+     * lower half, with arrows only where the path turns. Both the path to the
+     * cycle and the cycle are as long as possible, which is the worst case for
+     * detecting the infinite loop. */
+    MAZE_WORST_CASE,
+};
+
+#define MAZE_KINDS 5
+
+/**
+ * @brief Generates next pseudo-random number (xorshift64*).
+ * @param state State of the generator, must not be zero.
+ * @returns Pseudo-random number.
+ */
+uint64_t next_random(uint64_t *state);
+
+/**
+ * @brief Gets the name of the kind of the maze.
+ */
+const char *maze_kind_name(enum maze_kind_t kind);
+
+/**
+ * @brief Generates the map of the maze. Same seed always produces the same map.
+ * @param map Map to be filled, <code>width * height</code> cells.
+ * @param width Width of the map.
+ * @param height Height of the map.
+ * @param kind Kind of the maze.
+ * @param seed State of the generator, must not be zero.
+ * @param direction Output variable where the direction of the robot at the
+ * entrance is set.
+ * @returns Position of the entrance, i.e. the cell where the robot has the
+ * longest walk ahead of it.
+ */
+size_t generate_maze(char *map, size_t width, size_t height, enum maze_kind_t kind, uint64_t *seed, char *direction);
+
+#endif
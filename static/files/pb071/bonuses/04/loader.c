@@ -0,0 +1,92 @@
+#include "loader.h"
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/** Header holds two numbers, longer one is considered invalid. */
+#define MAX_HEADER 64
+
+/**
+ * @brief Parses decimal number from the header.
+ * @param current Current position in the header, moved past the number.
+ * @param end End of the header.
+ * @param number Output variable for the parsed number.
+ * @returns <code>true</code> if a number has been parsed, <code>false</code>
+ * otherwise or if the number does not fit into <code>size_t</code>.
+ */
+static bool parse_number(const char **current, const char *end, size_t *number)
+{
+    while (*current < end && **current == ' ') {
+        (*current)++;
+    }
+
+    const char *start = *current;
+    *number = 0;
+    while (*current < end && **current >= '0' && **current <= '9') {
+        size_t digit = (size_t) (**current - '0');
+        if (*number > (SIZE_MAX - digit) / 10) {
+            return false;
+        }
+        *number = 10 * *number + digit;
+        (*current)++;
+    }
+
+    return *current != start;
+}
+
+bool maze_file_open(struct maze_file *file, const char *path)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd == -1) {
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) == -1 || info.st_size == 0) {
+        close(fd);
+        return false;
+    }
+
+    // private writable mapping, so that the maze can be changed in memory
+    // (e.g. by the cache), pages are copied only when written to
+    file->length = (size_t) info.st_size;
+    file->mapping = mmap(NULL, file->length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (file->mapping == MAP_FAILED) {
+        return false;
+    }
+
+    const char *header = file->mapping;
+    const char *end = header + (file->length < MAX_HEADER ? file->length : MAX_HEADER);
+    const char *current = header;
+
+    bool valid = parse_number(&current, end, &file->width)
+            && parse_number(&current, end, &file->height)
+            && current < end && *current == '\n';
+
+    if (valid) {
+        size_t offset = (size_t) (current - header) + 1;
+
+        valid = (file->height == 0 || file->width <= SIZE_MAX / file->height)
+                && file->width * file->height <= file->length - offset;
+        file->map = (char *) file->mapping + offset;
+    }
+
+    if (!valid) {
+        munmap(file->mapping, file->length);
+        return false;
+    }
+
+    return true;
+}
+
+void maze_file_close(struct maze_file *file)
+{
+    munmap(file->mapping, file->length);
+    file->mapping = NULL;
+    file->map = NULL;
+}
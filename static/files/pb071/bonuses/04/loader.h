@@ -0,0 +1,40 @@
+#ifndef _LOADER_H
+#define _LOADER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @brief Maze that is mapped from the file into the memory.
+ *
+ * File starts with a header line <code>width height</code>, followed by
+ * <code>width * height</code> cells, row by row, without any separators.
+ * Cells are mapped directly from the file, so the maze is loaded instantly
+ * regardless of its size and pages are read only when the robot visits them.
+ */
+struct maze_file
+{
+    char *map;
+    size_t width;
+    size_t height;
+
+    void *mapping;
+    size_t length;
+};
+
+/**
+ * @brief Maps the maze from the file.
+ * @param file Maze to be loaded.
+ * @param path Path to the file.
+ * @returns <code>true</code> if the maze has been mapped, <code>false</code> if
+ * the file could not be opened or mapped, or its header is invalid.
+ */
+bool maze_file_open(struct maze_file *file, const char *path);
+
+/**
+ * @brief Unmaps the maze. Changes done to the map are never written to the file.
+ * @param file Maze to be unmapped.
+ */
+void maze_file_close(struct maze_file *file);
+
+#endif
@@ -1,8 +1,210 @@
+#include "batch.h"
+#include "cache.h"
+#include "loader.h"
 #include "maze.h"
+#include "render.h"
 
+#include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
 
-int main(void)
+/** Count of the queries that are answered at once. */
+#define CHUNK 4096
+#define MAX_LINE 256
+
+static const char *state_names[] = { "NONE", "FOUND_KEY", "FOUND_TREASURE", "OUT_OF_BOUNDS", "INFINITE_LOOP" };
+
+/**
+ * @brief Queries that are waiting to be answered.
+ */
+struct queries
+{
+    size_t count;
+    size_t positions[CHUNK];
+    char directions[CHUNK];
+    enum end_state_t results[CHUNK];
+};
+
+/**
+ * @brief Parses query in form <code>row col direction</code>.
+ * @param line Line with the query.
+ * @param maze Maze the query is for.
+ * @param queries Queries where the parsed one is appended.
+ * @returns <code>true</code> if the query is valid, <code>false</code> otherwise.
+ */
+static bool parse_query(const char *line, const struct maze_file *maze, struct queries *queries)
+{
+    size_t row, col;
+    char direction;
+    if (sscanf(line, "%zu %zu %c", &row, &col, &direction) != 3 || strchr("^v<>", direction) == NULL) {
+        return false;
+    }
+
+    // robots outside of the map fall off immediately
+    queries->positions[queries->count] = (row < maze->height && col < maze->width) ? row * maze->width + col : SIZE_MAX;
+    queries->directions[queries->count] = direction;
+    queries->count++;
+    return true;
+}
+
+/**
+ * @brief Options of the program.
+ */
+struct options
+{
+    bool precompute;
+    bool animate;
+    struct animation animation;
+};
+
+/**
+ * @brief Answers the waiting queries and writes the results to the output.
+ * @param maze Maze the queries are for.
+ * @param cache Precomputed cache of the maze, or <code>NULL</code> if the walks
+ * are to be simulated.
+ * @param options Options of the program.
+ * @param queries Queries to be answered.
+ * @returns <code>true</code> if the queries have been answered, <code>false
+ * </code> if the memory for the animation could not be allocated.
+ */
+static bool answer(const struct maze_file *maze, const struct maze_cache *cache, const struct options *options, struct queries *queries)
 {
-    return 0;
+    if (options->animate) {
+        struct renderer renderer;
+        renderer_init(&renderer, stdout);
+        bool animated = true;
+        for (size_t i = 0; animated && i < queries->count; i++) {
+            animated = animate_walk(&renderer, maze->map, queries->positions[i], queries->directions[i], maze->width, maze->height, &options->animation, &queries->results[i]);
+        }
+        renderer_destroy(&renderer);
+        if (!animated) {
+            queries->count = 0;
+            return false;
+        }
+    } else if (cache != NULL) {
+        for (size_t i = 0; i < queries->count; i++) {
+            size_t position = queries->positions[i];
+            queries->results[i] = position == SIZE_MAX
+                    ? OUT_OF_BOUNDS
+                    : maze_cache_walk(cache, position / maze->width, position % maze->width, queries->directions[i]);
+        }
+    } else {
+        walk_batch(maze->map, maze->width, maze->height, queries->count, queries->positions, queries->directions, queries->results);
+    }
+
+    for (size_t i = 0; i < queries->count; i++) {
+        fputs(state_names[queries->results[i]], stdout);
+        putchar('\n');
+    }
+    queries->count = 0;
+    return true;
+}
+
+/**
+ * @brief Main function of a program.
+ * @returns Exit code that denotes following:
+ *      0 in case of success
+ *      1 in case of invalid usage
+ *      2 in case of failure on the maze or query file, or when the memory
+ *        could not be allocated
+ *      3 in case of invalid query
+ */
+int main(int argc, char **argv)
+{
+    struct options options = { false, false, { 0, false } };
+    bool valid = true;
+
+    int option;
+    while ((option = getopt(argc, argv, "ca:s")) != -1) {
+        switch (option) {
+        case 'c':
+            options.precompute = true;
+            break;
+        case 'a':
+            options.animate = true;
+            options.animation.fps = strtod(optarg, NULL);
+            break;
+        case 's':
+            options.animation.skip_frames = true;
+            break;
+        default:
+            valid = false;
+            break;
+        }
+    }
+
+    int first = optind;
+    if (!valid || argc - first < 1 || argc - first > 2) {
+        printf("Usage: %s [-c] [-a fps [-s]] <maze-file> [query-file]\n", argv[0]);
+        printf("  -c      precompute end states of all walks before answering the queries\n");
+        printf("  -a fps  animate the walks in the terminal, at most fps frames per second\n");
+        printf("          (0 for no limit)\n");
+        printf("  -s      do not slow down the animated walks, skip the frames instead\n");
+        printf("Queries are read from the standard input by default, one per line, in form\n");
+        printf("'row col direction', e.g. '3 4 >'.\n");
+        return 1;
+    }
+    bool precompute = options.precompute && !options.animate;
+
+    struct maze_file maze;
+    if (!maze_file_open(&maze, argv[first])) {
+        fprintf(stderr, "Could not load the maze from %s\n", argv[first]);
+        return 2;
+    }
+
+    FILE *input = stdin;
+    if (argc - first == 2 && (input = fopen(argv[first + 1], "r")) == NULL) {
+        fprintf(stderr, "Could not open the queries from %s\n", argv[first + 1]);
+        maze_file_close(&maze);
+        return 2;
+    }
+
+    struct maze_cache cache;
+    if (precompute && !maze_cache_init_parallel(&cache, maze.map, maze.width, maze.height, 0, 0)) {
+        fprintf(stderr, "Could not precompute the maze\n");
+        if (input != stdin) {
+            fclose(input);
+        }
+        maze_file_close(&maze);
+        return 2;
+    }
+
+    static struct queries queries;
+    char line[MAX_LINE];
+    size_t line_number = 0;
+    int result = 0;
+    bool answered = true;
+
+    while (fgets(line, MAX_LINE, input) != NULL) {
+        line_number++;
+        if (line[0] == '\n' || line[0] == '#') {
+            continue;
+        }
+
+        if (!parse_query(line, &maze, &queries)) {
+            fprintf(stderr, "Invalid query on line %zu\n", line_number);
+            result = 3;
+            break;
+        }
+        if (queries.count == CHUNK && !answer(&maze, precompute ? &cache : NULL, &options, &queries)) {
+            answered = false;
+            break;
+        }
+    }
+    if (!answered || !answer(&maze, precompute ? &cache : NULL, &options, &queries)) {
+        fprintf(stderr, "Could not allocate the animation\n");
+        result = 2;
+    }
+
+    if (precompute) {
+        maze_cache_destroy(&cache);
+    }
+    if (input != stdin) {
+        fclose(input);
+    }
+    maze_file_close(&maze);
+    return result;
 }
@@ -4,6 +4,8 @@
 #include <stdio.h>
 #include <string.h>
 
+#define PRINT_BUFFER 4096
+
 /**
  * @brief Checks if pointer points inside the memory specified by upper and lower
  * bound.
@@ -45,8 +47,27 @@ static bool within_bounds_by_index(size_t width, size_t height, size_t row, size
     /* TODO */
 }
 
+/**
+ * @brief Appends character to the output buffer, buffer is written out once it
+ * is full.
+ * @param buffer Output buffer of <code>PRINT_BUFFER</code> characters.
+ * @param length Count of the characters in the buffer.
+ * @param c Character to be appended.
+ */
+static void buffered_putchar(char *buffer, size_t *length, char c)
+{
+    if (*length == PRINT_BUFFER) {
+        fwrite(buffer, 1, *length, stdout);
+        *length = 0;
+    }
+    buffer[(*length)++] = c;
+}
+
 void print_maze(const char *map, char *position, char direction, size_t width, size_t height)
 {
+    char buffer[PRINT_BUFFER];
+    size_t length = 0;
+
     printf("Maze:\n");
     for (size_t row = 0; row < height; row++) {
         for (size_t col = 0; col < width; col++) {
@@ -55,26 +76,27 @@ void print_maze(const char *map, char *position, char direction, size_t width, s
             if (current == position) {
                 switch (direction) {
                 case '^':
-                    putchar('N');
+                    buffered_putchar(buffer, &length, 'N');
                     break;
                 case 'v':
-                    putchar('S');
+                    buffered_putchar(buffer, &length, 'S');
                     break;
                 case '>':
-                    putchar('E');
+                    buffered_putchar(buffer, &length, 'E');
                     break;
                 case '<':
-                    putchar('W');
+                    buffered_putchar(buffer, &length, 'W');
                     break;
                 }
                 continue;
             }
 
-            putchar(*current);
+            buffered_putchar(buffer, &length, *current);
         }
-        putchar('\n');
+        buffered_putchar(buffer, &length, '\n');
     }
-    putchar('\n');
+    buffered_putchar(buffer, &length, '\n');
+    fwrite(buffer, 1, length, stdout);
 }
 
 enum end_state_t walk(const char *map, char *position, char direction, size_t width, size_t height)
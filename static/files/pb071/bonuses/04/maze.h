@@ -1,3 +1,6 @@
+#ifndef _MAZE_H
+#define _MAZE_H
+
 #include <stdlib.h>
 
 enum end_state_t
@@ -31,3 +34,5 @@ void print_maze(const char *map, char *position, char direction, size_t width, s
  * manually.
  */
 enum end_state_t walk(const char *map, char *position, char direction, size_t width, size_t height);
+
+#endif
@@ -0,0 +1,122 @@
+#include "packed.h"
+
+#include <stdlib.h>
+
+#define TILE_CELLS (PACKED_TILE_SIDE * PACKED_TILE_SIDE)
+
+/**
+ * @brief Spreads the lower 4 bits of the number, so that there is a zero bit
+ * between each pair of them.
+ */
+static size_t spread_bits(size_t x)
+{
+    x = (x | (x << 2)) & 0x33;
+    x = (x | (x << 1)) & 0x55;
+    return x;
+}
+
+/**
+ * @brief Computes index of the cell within the packed data.
+ * @param maze Packed maze.
+ * @param row Row of the cell.
+ * @param col Column of the cell.
+ * @returns Index of the nibble that holds the cell.
+ */
+static size_t cell_index(const struct packed_maze *maze, size_t row, size_t col)
+{
+    if (maze->layout == LAYOUT_ROWS) {
+        return row * maze->width + col;
+    }
+
+    size_t tile = (row / PACKED_TILE_SIDE) * maze->tiles_per_row + col / PACKED_TILE_SIDE;
+    size_t within = spread_bits(col % PACKED_TILE_SIDE) | (spread_bits(row % PACKED_TILE_SIDE) << 1);
+    return tile * TILE_CELLS + within;
+}
+
+bool packed_maze_init(struct packed_maze *maze, const char *map, size_t width, size_t height, enum packed_layout_t layout)
+{
+    maze->width = width;
+    maze->height = height;
+    maze->layout = layout;
+    maze->tiles_per_row = (width + PACKED_TILE_SIDE - 1) / PACKED_TILE_SIDE;
+
+    size_t cells = width * height;
+    if (height != 0 && cells / height != width) {
+        return false;
+    }
+    if (layout == LAYOUT_TILED) {
+        size_t tiles_per_col = (height + PACKED_TILE_SIDE - 1) / PACKED_TILE_SIDE;
+        cells = maze->tiles_per_row * tiles_per_col * TILE_CELLS;
+    }
+
+    // calloc leaves the padding of the tiles as empty cells
+    maze->data = calloc(cells / 2 + 1, 1);
+    if (maze->data == NULL) {
+        return false;
+    }
+
+    for (size_t row = 0; row < height; row++) {
+        for (size_t col = 0; col < width; col++) {
+            packed_maze_set(maze, row, col, cell_from_char(*map++));
+        }
+    }
+
+    return true;
+}
+
+void packed_maze_destroy(struct packed_maze *maze)
+{
+    free(maze->data);
+    maze->data = NULL;
+}
+
+enum cell_t packed_maze_get(const struct packed_maze *maze, size_t row, size_t col)
+{
+    size_t index = cell_index(maze, row, col);
+    return (enum cell_t) ((maze->data[index / 2] >> (4 * (index % 2))) & 0xF);
+}
+
+void packed_maze_set(struct packed_maze *maze, size_t row, size_t col, enum cell_t cell)
+{
+    size_t index = cell_index(maze, row, col);
+    unsigned shift = 4 * (index % 2);
+
+    unsigned char *byte = &maze->data[index / 2];
+    *byte = (unsigned char) ((*byte & ~(0xF << shift)) | (cell << shift));
+}
+
+/**
+ * @brief Does one step of the robot in the packed maze.
+ * @param maze Packed maze.
+ * @param robot Robot to be moved.
+ * @returns <code>NONE</code> if the robot continues walking, end state otherwise.
+ */
+static enum end_state_t advance(const struct packed_maze *maze, struct robot *robot)
+{
+    enum end_state_t state = enter_cell(packed_maze_get(maze, robot->row, robot->col), &robot->direction);
+    if (state != NONE) {
+        return state;
+    }
+
+    return move_robot(robot, maze->width, maze->height) ? NONE : OUT_OF_BOUNDS;
+}
+
+enum end_state_t packed_walk(const struct packed_maze *maze, size_t row, size_t col, char direction)
+{
+    if (row >= maze->height || col >= maze->width) {
+        return OUT_OF_BOUNDS;
+    }
+
+    struct robot hare = { row, col, direction_from_char(direction) };
+    struct cycle_detector detector = { hare, 1, 1 };
+
+    enum end_state_t state = advance(maze, &hare);
+    while (state == NONE) {
+        if (cycle_detected(&detector, &hare)) {
+            return INFINITE_LOOP;
+        }
+        state = advance(maze, &hare);
+    }
+
+    return state;
+}
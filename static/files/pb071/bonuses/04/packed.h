@@ -0,0 +1,85 @@
+#ifndef _PACKED_H
+#define _PACKED_H
+
+#include "cell.h"
+#include "maze.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * Side of the square tile used by the tiled layout. Tile of 16×16 cells takes
+ * 128 bytes, i.e. two cache lines.
+ */
+#define PACKED_TILE_SIDE 16
+
+enum packed_layout_t
+{
+    /** Cells are stored row by row, same as in the original map. */
+    LAYOUT_ROWS,
+    /** Map is split into tiles stored one after another, cells within the tile
+     * follow the Z-order curve, so that neighbouring cells share cache lines
+     * regardless of the direction of the walk. */
+    LAYOUT_TILED,
+};
+
+/**
+ * @brief Map of the maze that stores each cell in 4 bits.
+ */
+struct packed_maze
+{
+    unsigned char *data;
+    size_t width;
+    size_t height;
+    enum packed_layout_t layout;
+    size_t tiles_per_row;
+};
+
+/**
+ * @brief Encodes the map into the packed representation.
+ * @param maze Packed maze to be initialized.
+ * @param map Map of the maze, one character per cell.
+ * @param width Width of the map.
+ * @param height Height of the map.
+ * @param layout Layout of the cells in the memory.
+ * @returns <code>true</code> if the maze has been encoded, <code>false</code>
+ * if the memory could not be allocated.
+ */
+bool packed_maze_init(struct packed_maze *maze, const char *map, size_t width, size_t height, enum packed_layout_t layout);
+
+/**
+ * @brief Frees the memory held by the packed maze.
+ * @param maze Packed maze to be destroyed.
+ */
+void packed_maze_destroy(struct packed_maze *maze);
+
+/**
+ * @brief Gets kind of the cell at the given coordinates.
+ * @param maze Packed maze.
+ * @param row Row of the cell, must be within the map.
+ * @param col Column of the cell, must be within the map.
+ * @returns Kind of the cell.
+ */
+enum cell_t packed_maze_get(const struct packed_maze *maze, size_t row, size_t col);
+
+/**
+ * @brief Sets kind of the cell at the given coordinates.
+ * @param maze Packed maze.
+ * @param row Row of the cell, must be within the map.
+ * @param col Column of the cell, must be within the map.
+ * @param cell New kind of the cell.
+ */
+void packed_maze_set(struct packed_maze *maze, size_t row, size_t col, enum cell_t cell);
+
+/**
+ * @brief Get end state of the robot after his walk in the packed maze.
+ * @param maze Packed maze.
+ * @param row Initial row of the robot.
+ * @param col Initial column of the robot.
+ * @param direction Direction the robot is facing at the beginning, one of "^v<>".
+ * @returns End state of the robot after his walk, same as <code>walk</code>
+ * would return on the original map.
+ */
+enum end_state_t packed_walk(const struct packed_maze *maze, size_t row, size_t col, char direction);
+
+#endif
@@ -0,0 +1,206 @@
+#include "render.h"
+
+#include "cell.h"
+#include "clock.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define CLEAR_SCREEN "\033[H\033[2J"
+
+/** Longest cursor-addressed update of a single cell. */
+#define MAX_CELL_UPDATE 48
+
+/**
+ * @brief Makes sure there is enough space for the given count of characters.
+ * @returns <code>true</code> if there is enough space, <code>false</code> if the
+ * buffer could not be enlarged.
+ */
+static bool reserve(struct renderer *renderer, size_t extra)
+{
+    if (renderer->length + extra <= renderer->capacity) {
+        return true;
+    }
+
+    size_t capacity = renderer->capacity != 0 ? renderer->capacity : 4096;
+    while (capacity < renderer->length + extra) {
+        capacity *= 2;
+    }
+
+    char *buffer = realloc(renderer->buffer, capacity);
+    if (buffer == NULL) {
+        return false;
+    }
+
+    renderer->buffer = buffer;
+    renderer->capacity = capacity;
+    return true;
+}
+
+static void flush(struct renderer *renderer)
+{
+    fwrite(renderer->buffer, 1, renderer->length, renderer->output);
+    fflush(renderer->output);
+    renderer->length = 0;
+}
+
+/**
+ * @brief Gets the character that represents the robot facing the direction.
+ */
+static char robot_marker(enum direction_t direction)
+{
+    return "NESW"[direction];
+}
+
+void renderer_init(struct renderer *renderer, FILE *output)
+{
+    renderer->output = output;
+    renderer->buffer = NULL;
+    renderer->length = 0;
+    renderer->capacity = 0;
+}
+
+void renderer_destroy(struct renderer *renderer)
+{
+    free(renderer->buffer);
+    renderer->buffer = NULL;
+    renderer->capacity = 0;
+}
+
+/**
+ * @brief Appends the whole frame to the buffer.
+ */
+static bool append_frame(struct renderer *renderer, const char *map, size_t position, char direction, size_t width, size_t height)
+{
+    // one more character for the terminating null byte written by sprintf
+    if (!reserve(renderer, strlen("Maze:\n") + height * (width + 1) + 2)) {
+        return false;
+    }
+
+    char *out = renderer->buffer + renderer->length;
+    out += sprintf(out, "Maze:\n");
+    for (size_t row = 0; row < height; row++) {
+        memcpy(out, &map[row * width], width);
+        out += width;
+        *out++ = '\n';
+    }
+    *out++ = '\n';
+
+    // robot is drawn over the copied rows, unknown direction hides it
+    if (position < width * height && strchr("^>v<", direction) != NULL && direction != '\0') {
+        size_t row = position / width;
+        renderer->buffer[renderer->length + strlen("Maze:\n") + row * (width + 1) + position % width]
+                = robot_marker(direction_from_char(direction));
+    }
+
+    renderer->length = (size_t) (out - renderer->buffer);
+    return true;
+}
+
+bool render_frame(struct renderer *renderer, const char *map, size_t position, char direction, size_t width, size_t height)
+{
+    if (!append_frame(renderer, map, position, direction, width, height)) {
+        return false;
+    }
+
+    flush(renderer);
+    return true;
+}
+
+/**
+ * @brief Appends update of a single cell, addressed by the cursor position.
+ */
+static bool append_cell(struct renderer *renderer, size_t row, size_t col, char c)
+{
+    if (!reserve(renderer, MAX_CELL_UPDATE)) {
+        return false;
+    }
+
+    // first line of the frame holds the header
+    renderer->length += (size_t) sprintf(renderer->buffer + renderer->length, "\033[%zu;%zuH%c", row + 2, col + 1, c);
+    return true;
+}
+
+/**
+ * @brief Waits until the given time of the monotonic clock.
+ */
+static void sleep_until(double deadline)
+{
+    double remaining = deadline - now_seconds();
+    if (remaining <= 0) {
+        return;
+    }
+
+    struct timespec duration = { (time_t) remaining, (long) ((remaining - (double) (time_t) remaining) * 1e9) };
+    nanosleep(&duration, NULL);
+}
+
+bool animate_walk(struct renderer *renderer,
+        const char *map,
+        size_t position,
+        char direction,
+        size_t width,
+        size_t height,
+        const struct animation *animation,
+        enum end_state_t *state)
+{
+    if (position >= width * height) {
+        *state = OUT_OF_BOUNDS;
+        return true;
+    }
+
+    struct robot hare = { position / width, position % width, direction_from_char(direction) };
+    struct cycle_detector detector = { hare, 1, 1 };
+    struct robot shown = hare;
+
+    double interval = animation->fps > 0 ? 1 / animation->fps : 0;
+    double next_frame = now_seconds() + interval;
+
+    renderer->length = 0;
+    if (!reserve(renderer, strlen(CLEAR_SCREEN) + 1)) {
+        return false;
+    }
+    renderer->length += (size_t) sprintf(renderer->buffer, CLEAR_SCREEN);
+    if (!append_frame(renderer, map, position, direction, width, height)) {
+        return false;
+    }
+    flush(renderer);
+
+    enum end_state_t result = NONE;
+    while (result == NONE) {
+        result = enter_cell(cell_from_char(map[hare.row * width + hare.col]), &hare.direction);
+        if (result == NONE && !move_robot(&hare, width, height)) {
+            result = OUT_OF_BOUNDS;
+        }
+        if (result == NONE && cycle_detected(&detector, &hare)) {
+            result = INFINITE_LOOP;
+        }
+
+        if (animation->skip_frames && result == NONE && now_seconds() < next_frame) {
+            continue;
+        }
+        if (!animation->skip_frames) {
+            sleep_until(next_frame);
+        }
+        next_frame = now_seconds() + interval;
+
+        // only the previous and current cell of the robot have changed
+        if (!robot_equal(&shown, &hare)) {
+            if (!append_cell(renderer, shown.row, shown.col, map[shown.row * width + shown.col])
+                    || !append_cell(renderer, hare.row, hare.col, robot_marker(hare.direction))) {
+                return false;
+            }
+            flush(renderer);
+            shown = hare;
+        }
+    }
+
+    // leave the cursor below the maze
+    if (!append_cell(renderer, height + 1, 0, '\n')) {
+        return false;
+    }
+    flush(renderer);
+    *state = result;
+    return true;
+}
@@ -0,0 +1,86 @@
+#ifndef _RENDER_H
+#define _RENDER_H
+
+#include "maze.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+/**
+ * @brief Renders the maze into a buffer that is reused between the frames, each
+ * frame is written with a single call to <code>fwrite</code>.
+ */
+struct renderer
+{
+    FILE *output;
+    char *buffer;
+    size_t length;
+    size_t capacity;
+};
+
+/**
+ * @brief Options of the animated walk.
+ */
+struct animation
+{
+    /** Maximum count of the frames per second, 0 for no limit. */
+    double fps;
+    /** If set, the walk is not slowed down and the steps that happen between
+     * two frames are merged into the latter one, otherwise each step is shown
+     * in its own frame. */
+    bool skip_frames;
+};
+
+/**
+ * @brief Initializes the renderer.
+ * @param renderer Renderer to be initialized.
+ * @param output File where the frames are written.
+ */
+void renderer_init(struct renderer *renderer, FILE *output);
+
+/**
+ * @brief Frees the buffer held by the renderer.
+ * @param renderer Renderer to be destroyed.
+ */
+void renderer_destroy(struct renderer *renderer);
+
+/**
+ * @brief Renders the maze and the robot within it, output is the same as the
+ * one of <code>print_maze</code>.
+ * @param renderer Renderer.
+ * @param map Map of the maze.
+ * @param position Current position of the robot as an offset in the map.
+ * @param direction Direction the robot is facing, one of "^v<>".
+ * @param width Width of the map.
+ * @param height Height of the map.
+ * @returns <code>true</code> if the frame has been written, <code>false</code>
+ * if the memory could not be allocated.
+ */
+bool render_frame(struct renderer *renderer, const char *map, size_t position, char direction, size_t width, size_t height);
+
+/**
+ * @brief Animates the walk of the robot in the terminal. Whole maze is drawn
+ * only once, afterwards only the cells that have changed since the last frame
+ * are redrawn using cursor addressing.
+ * @param renderer Renderer.
+ * @param map Map of the maze.
+ * @param position Initial position of the robot as an offset in the map.
+ * @param direction Direction the robot is facing at the beginning.
+ * @param width Width of the map.
+ * @param height Height of the map.
+ * @param animation Options of the animation.
+ * @param state Output parameter for the end state of the robot after his walk.
+ * @returns <code>true</code> if the walk has been animated, <code>false</code>
+ * if the memory could not be allocated (the state is left untouched).
+ */
+bool animate_walk(struct renderer *renderer,
+        const char *map,
+        size_t position,
+        char direction,
+        size_t width,
+        size_t height,
+        const struct animation *animation,
+        enum end_state_t *state);
+
+#endif
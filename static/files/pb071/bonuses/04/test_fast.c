@@ -0,0 +1,407 @@
+#include "batch.h"
+#include "cache.h"
+#include "generate.h"
+#include "loader.h"
+#include "maze.h"
+#include "packed.h"
+#include "render.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define CUT_MAIN
+#include "cut.h"
+
+static void check_packed(const char *map, size_t position, char direction, size_t width, size_t height, enum end_state_t expected)
+{
+    const enum packed_layout_t layouts[] = { LAYOUT_ROWS, LAYOUT_TILED };
+
+    for (size_t i = 0; i < 2; i++) {
+        struct packed_maze maze;
+        ASSERT(packed_maze_init(&maze, map, width, height, layouts[i]));
+        ASSERT(packed_walk(&maze, position / width, position % width, direction) == expected);
+        packed_maze_destroy(&maze);
+    }
+}
+
+static void check_cache(const struct maze_cache *cache)
+{
+    struct packed_maze maze;
+    ASSERT(packed_maze_init(&maze, cache->map, cache->width, cache->height, LAYOUT_ROWS));
+
+    for (size_t row = 0; row < cache->height; row++) {
+        for (size_t col = 0; col < cache->width; col++) {
+            for (size_t dir = 0; dir < 4; dir++) {
+                char direction = "^>v<"[dir];
+                ASSERT(maze_cache_walk(cache, row, col, direction) == packed_walk(&maze, row, col, direction));
+            }
+        }
+    }
+
+    packed_maze_destroy(&maze);
+}
+
+TEST(packed)
+{
+    SUBTEST(encodes_all_cells)
+    {
+        const char *map = (".^v<>KT.."
+                           "TK><v^..."
+                           ".........");
+        const enum packed_layout_t layouts[] = { LAYOUT_ROWS, LAYOUT_TILED };
+
+        for (size_t i = 0; i < 2; i++) {
+            struct packed_maze maze;
+            ASSERT(packed_maze_init(&maze, map, 9, 3, layouts[i]));
+            for (size_t cell = 0; cell < 27; cell++) {
+                ASSERT(cell_to_char(packed_maze_get(&maze, cell / 9, cell % 9)) == map[cell]);
+            }
+            packed_maze_destroy(&maze);
+        }
+    }
+    SUBTEST(walks)
+    {
+        check_packed(("..........................T"), 7, 'v', 1, 27, FOUND_TREASURE);
+        check_packed(("..........................K"), 2, '>', 27, 1, FOUND_KEY);
+        check_packed((">..v"
+                      "...."
+                      "...K"
+                      "^..<"),
+                12,
+                '>',
+                4,
+                4,
+                FOUND_KEY);
+        check_packed((".>.."
+                      "^KTK"
+                      ".TvT"
+                      "...<"),
+                15,
+                '>',
+                4,
+                4,
+                OUT_OF_BOUNDS);
+        check_packed((".."
+                      ".."),
+                4,
+                'v',
+                2,
+                2,
+                OUT_OF_BOUNDS);
+    }
+    SUBTEST(loops)
+    {
+        check_packed(("v.v"
+                      "..."
+                      "^.^"),
+                0,
+                '>',
+                3,
+                3,
+                INFINITE_LOOP);
+        check_packed((">.v.."
+                      "....."
+                      "^...<"
+                      "....."
+                      "..>.^"),
+                4,
+                'v',
+                5,
+                5,
+                INFINITE_LOOP);
+    }
+}
+
+TEST(batch)
+{
+    SUBTEST(no_way_to_avoid)
+    {
+        const char *map = (">>>>v"
+                           "^>>vv"
+                           "^^T<v"
+                           "^^<<<"
+                           "^<<<<");
+        size_t positions[100];
+        char directions[100];
+        enum end_state_t results[100];
+
+        for (size_t i = 0; i < 100; i++) {
+            positions[i] = i / 4;
+            directions[i] = "<>^v"[i % 4];
+        }
+
+        walk_batch(map, 5, 5, 100, positions, directions, results);
+        for (size_t i = 0; i < 100; i++) {
+            ASSERT(results[i] == FOUND_TREASURE);
+        }
+    }
+    SUBTEST(same_as_packed)
+    {
+        const char *map = (">.v.K"
+                           ".T..."
+                           "^...<"
+                           "..v.."
+                           "..>.^");
+        size_t positions[102];
+        char directions[102];
+        enum end_state_t results[102];
+
+        for (size_t i = 0; i < 100; i++) {
+            positions[i] = i / 4;
+            directions[i] = "<>^v"[i % 4];
+        }
+        positions[100] = 25;
+        directions[100] = '^';
+        positions[101] = (size_t) -1;
+        directions[101] = 'v';
+
+        walk_batch(map, 5, 5, 102, positions, directions, results);
+
+        struct packed_maze maze;
+        ASSERT(packed_maze_init(&maze, map, 5, 5, LAYOUT_ROWS));
+        for (size_t i = 0; i < 100; i++) {
+            ASSERT(results[i] == packed_walk(&maze, positions[i] / 5, positions[i] % 5, directions[i]));
+        }
+        packed_maze_destroy(&maze);
+
+        ASSERT(results[100] == OUT_OF_BOUNDS);
+        ASSERT(results[101] == OUT_OF_BOUNDS);
+    }
+    SUBTEST(last_cells)
+    {
+        // cells at the end of the map are read byte by byte, the map has no
+        // terminating null byte
+        char *map = malloc(7);
+        ASSERT(map != NULL);
+        memcpy(map, ">.v<.^T", 7);
+
+        size_t positions[28];
+        char directions[28];
+        enum end_state_t results[28];
+
+        for (size_t i = 0; i < 28; i++) {
+            positions[i] = i / 4;
+            directions[i] = "<>^v"[i % 4];
+        }
+
+        walk_batch(map, 7, 1, 28, positions, directions, results);
+
+        struct packed_maze maze;
+        ASSERT(packed_maze_init(&maze, map, 7, 1, LAYOUT_ROWS));
+        for (size_t i = 0; i < 28; i++) {
+            ASSERT(results[i] == packed_walk(&maze, 0, positions[i], directions[i]));
+        }
+        packed_maze_destroy(&maze);
+        free(map);
+    }
+}
+
+TEST(cache)
+{
+    SUBTEST(same_as_walk)
+    {
+        char map[] = ">.v.."
+                     "....."
+                     "^...<"
+                     "....."
+                     "..>.^";
+        struct maze_cache cache;
+        ASSERT(maze_cache_init(&cache, map, 5, 5));
+
+        ASSERT(maze_cache_walk(&cache, 0, 4, 'v') == INFINITE_LOOP);
+        ASSERT(maze_cache_walk(&cache, 1, 1, '<') == OUT_OF_BOUNDS);
+        ASSERT(maze_cache_walk(&cache, 5, 0, '^') == OUT_OF_BOUNDS);
+        check_cache(&cache);
+
+        maze_cache_destroy(&cache);
+    }
+    SUBTEST(updates)
+    {
+        char map[] = ">.v.K."
+                     ".T...."
+                     "^...<."
+                     "..v..v"
+                     "..>.^."
+                     "<.....";
+        const char *cells = ".^>v<KT";
+        struct maze_cache cache;
+        ASSERT(maze_cache_init(&cache, map, 6, 6));
+
+        for (size_t i = 0; i < 50; i++) {
+            size_t cell = (i * 7) % 36;
+            ASSERT(maze_cache_update(&cache, cell / 6, cell % 6, cells[i % 7]) != (size_t) -1);
+            ASSERT(map[cell] == cells[i % 7]);
+            check_cache(&cache);
+        }
+
+        maze_cache_destroy(&cache);
+    }
+    SUBTEST(only_affected_states)
+    {
+        char map[] = "T..."
+                     "^..."
+                     "...."
+                     "....";
+        struct maze_cache cache;
+        ASSERT(maze_cache_init(&cache, map, 4, 4));
+
+        // arrow is reached only from the cells below it and to the right of it
+        ASSERT(maze_cache_update(&cache, 1, 0, 'v') == 4 + 2 + 3);
+        ASSERT(maze_cache_walk(&cache, 3, 0, '^') == OUT_OF_BOUNDS);
+        check_cache(&cache);
+
+        maze_cache_destroy(&cache);
+    }
+    SUBTEST(parallel)
+    {
+        char map[] = ">.v.K.v"
+                     ".T....."
+                     "^...<.<"
+                     "..v..v."
+                     "..>.^.."
+                     "<......"
+                     ">.....^";
+
+        struct maze_cache sequential;
+        ASSERT(maze_cache_init(&sequential, map, 7, 7));
+
+        for (size_t side = 1; side <= 8; side++) {
+            struct maze_cache parallel;
+            ASSERT(maze_cache_init_parallel(&parallel, map, 7, 7, 3, side));
+            for (size_t state = 0; state < 4 * 7 * 7; state++) {
+                ASSERT(parallel.outcomes[state] == sequential.outcomes[state]);
+            }
+            maze_cache_destroy(&parallel);
+        }
+
+        maze_cache_destroy(&sequential);
+    }
+}
+
+static void check_loader(const char *contents, bool valid)
+{
+    char path[] = "/tmp/test_maze_XXXXXX";
+    int fd = mkstemp(path);
+    ASSERT(fd != -1);
+    ASSERT(write(fd, contents, strlen(contents)) == (ssize_t) strlen(contents));
+    close(fd);
+
+    struct maze_file maze;
+    ASSERT(maze_file_open(&maze, path) == valid);
+    if (valid) {
+        ASSERT(maze.width == 4);
+        ASSERT(maze.height == 2);
+        ASSERT(memcmp(maze.map, ">..v^..<", 8) == 0);
+        maze_file_close(&maze);
+    }
+
+    unlink(path);
+}
+
+TEST(loader)
+{
+    SUBTEST(valid)
+    {
+        check_loader("4 2\n>..v^..<", true);
+        check_loader("4 2\n>..v^..<\n", true);
+    }
+    SUBTEST(invalid)
+    {
+        check_loader("4 2\n>..v^..", false);
+        check_loader("4 2 >..v^..<", false);
+        check_loader("4\n>..v^..<", false);
+        check_loader("", false);
+    }
+    SUBTEST(overflow)
+    {
+        check_loader("18446744073709551617 1\n>", false);
+        check_loader("4294967296 4294967296\n>", false);
+    }
+}
+
+static void check_output(FILE *file, const char *expected)
+{
+    char output[256] = { 0 };
+
+    rewind(file);
+    ASSERT(fread(output, 1, sizeof(output) - 1, file) == strlen(expected));
+    ASSERT(strcmp(output, expected) == 0);
+}
+
+TEST(render)
+{
+    SUBTEST(frame)
+    {
+        FILE *file = tmpfile();
+        struct renderer renderer;
+        renderer_init(&renderer, file);
+
+        ASSERT(render_frame(&renderer, ">.v.K.", 3, '>', 3, 2));
+        check_output(file, "Maze:\n>.v\nEK.\n\n");
+
+        renderer_destroy(&renderer);
+        fclose(file);
+    }
+    SUBTEST(animation)
+    {
+        FILE *file = tmpfile();
+        struct renderer renderer;
+        renderer_init(&renderer, file);
+
+        struct animation animation = { 0, true };
+        enum end_state_t state = NONE;
+        ASSERT(animate_walk(&renderer, ".K.", 0, '>', 3, 1, &animation, &state));
+        ASSERT(state == FOUND_KEY);
+        check_output(file, "\033[H\033[2JMaze:\nEK.\n\n\033[2;1H.\033[2;2HE\033[4;1H\n");
+
+        renderer_destroy(&renderer);
+        fclose(file);
+    }
+}
+
+TEST(generate)
+{
+    SUBTEST(deterministic)
+    {
+        char first[64 * 64], second[64 * 64];
+        uint64_t seed = 42;
+        char direction;
+
+        for (size_t kind = 0; kind < MAZE_KINDS; kind++) {
+            uint64_t first_seed = seed, second_seed = seed;
+            size_t entrance = generate_maze(first, 64, 64, (enum maze_kind_t) kind, &first_seed, &direction);
+            ASSERT(generate_maze(second, 64, 64, (enum maze_kind_t) kind, &second_seed, &direction) == entrance);
+            ASSERT(memcmp(first, second, sizeof(first)) == 0);
+        }
+    }
+    SUBTEST(long_walks)
+    {
+        const size_t sides[][2] = { { 3, 2 }, { 4, 4 }, { 7, 5 }, { 10, 9 }, { 33, 40 } };
+        const enum end_state_t expected[] = { FOUND_TREASURE, INFINITE_LOOP, INFINITE_LOOP, INFINITE_LOOP };
+        char map[40 * 40];
+
+        for (size_t i = 0; i < sizeof(sides) / sizeof(sides[0]); i++) {
+            size_t width = sides[i][0], height = sides[i][1];
+            for (size_t kind = MAZE_SPIRAL; kind < MAZE_KINDS; kind++) {
+                uint64_t seed = 1;
+                char direction;
+                size_t entrance = generate_maze(map, width, height, (enum maze_kind_t) kind, &seed, &direction);
+
+                enum end_state_t state;
+                size_t steps = walk_batch_scalar(map, width, height, 1, &entrance, &direction, &state);
+                ASSERT(state == expected[kind - MAZE_SPIRAL]);
+                check_packed(map, entrance, direction, width, height, state);
+
+                // spiral visits every cell before reaching the treasure
+                ASSERT(kind != MAZE_SPIRAL || steps == width * height);
+
+                struct maze_cache cache;
+                ASSERT(maze_cache_init(&cache, map, width, height));
+                check_cache(&cache);
+                maze_cache_destroy(&cache);
+            }
+        }
+    }
+}
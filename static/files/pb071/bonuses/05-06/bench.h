@@ -0,0 +1,47 @@
+#ifndef _BENCH_H
+#define _BENCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+/**
+ * @brief Returns current time of the monotonic clock.
+ * @returns Time in seconds.
+ */
+static inline double now_seconds(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double) now.tv_sec + (double) now.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Generates next pseudo-random number (xorshift64*).
+ * @param state State of the generator, must not be zero.
+ * @returns Pseudo-random number.
+ */
+static inline uint64_t next_random(uint64_t *state)
+{
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return *state * 0x2545F4914F6CDD1DULL;
+}
+
+/**
+ * @brief Fills the buffer with printable text, mostly letters of both cases
+ * with spaces and punctuation in between.
+ * @param text Buffer to be filled.
+ * @param length Count of the characters.
+ * @param seed State of the generator.
+ */
+static inline void fill_text(char *text, size_t length, uint64_t *seed)
+{
+    static const char alphabet[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ   ,.!?0123";
+    for (size_t i = 0; i < length; i++) {
+        text[i] = alphabet[next_random(seed) % (sizeof(alphabet) - 1)];
+    }
+}
+
+#endif
@@ -0,0 +1,489 @@
+#include "bench.h"
+#include "bmp.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define HAVE_TSC
+#endif
+
+#define SMALLEST 16
+#define DEFAULT_LARGEST ((size_t) 256 << 20)
+#define DEFAULT_TARGET 0.2
+#define DEFAULT_TOLERANCE 10.0
+#define KEY "CoMPuTeR"
+#define MAX_LINE 256
+
+/*
+ * Allocations are counted only when the allocator is wrapped by the linker
+ * (-Wl,--wrap=malloc,...), calls from the student's implementation end up in
+ * the functions below then.
+ */
+#ifdef COUNT_ALLOCATIONS
+static size_t allocations = 0;
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *pointer, size_t size);
+
+void *__wrap_malloc(size_t size)
+{
+    allocations++;
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t count, size_t size)
+{
+    allocations++;
+    return __real_calloc(count, size);
+}
+
+void *__wrap_realloc(void *pointer, size_t size)
+{
+    allocations++;
+    return __real_realloc(pointer, size);
+}
+#endif
+
+/**
+ * @brief Returns current value of the time-stamp counter.
+ * @returns Count of the reference cycles, or 0 if there is no such counter.
+ */
+static inline uint64_t now_cycles(void)
+{
+#ifdef HAVE_TSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+/**
+ * @brief Runs the benchmarked function on the input.
+ * @param input Input of the function, terminated by zero.
+ * @returns Result of the function, it is freed by the caller.
+ */
+typedef void *(*run_t)(const void *input);
+
+static void *run_reverse(const void *input)
+{
+    return reverse(input);
+}
+
+static void *run_vigenere_encrypt(const void *input)
+{
+    return vigenere_encrypt(KEY, input);
+}
+
+static void *run_vigenere_decrypt(const void *input)
+{
+    return vigenere_decrypt(KEY, input);
+}
+
+static void *run_bit_encrypt(const void *input)
+{
+    return bit_encrypt(input);
+}
+
+static void *run_bit_decrypt(const void *input)
+{
+    return bit_decrypt(input);
+}
+
+static void *run_bmp_encrypt(const void *input)
+{
+    return bmp_encrypt(KEY, input);
+}
+
+static void *run_bmp_decrypt(const void *input)
+{
+    return bmp_decrypt(KEY, input);
+}
+
+/**
+ * @brief Benchmarked function, decryption is measured on the output of the
+ * corresponding encryption.
+ */
+struct function
+{
+    const char *name;
+    run_t run;
+    run_t prepare;
+};
+
+static const struct function functions[] = {
+    { "reverse", run_reverse, NULL },
+    { "vigenere_encrypt", run_vigenere_encrypt, NULL },
+    { "vigenere_decrypt", run_vigenere_decrypt, run_vigenere_encrypt },
+    { "bit_encrypt", run_bit_encrypt, NULL },
+    { "bit_decrypt", run_bit_decrypt, run_bit_encrypt },
+    { "bmp_encrypt", run_bmp_encrypt, NULL },
+    { "bmp_decrypt", run_bmp_decrypt, run_bmp_encrypt },
+};
+
+#define FUNCTIONS (sizeof(functions) / sizeof(functions[0]))
+
+/**
+ * @brief Result of one measurement.
+ */
+struct result
+{
+    char name[32];
+    size_t bytes;
+    double megabytes_per_second;
+    double cycles_per_byte;
+    double allocations_per_call;
+};
+
+/**
+ * @brief Measures the function on the input, it is called repeatedly until
+ * the target time elapses.
+ * @param function Function to be measured.
+ * @param input Input of the function.
+ * @param bytes Length of the input.
+ * @param target Least time spent in the function, in seconds.
+ * @param result Output of the measurement.
+ * @returns <code>true</code> if the function is implemented, <code>false
+ * </code> if it has returned <code>NULL</code>.
+ */
+static bool measure(const struct function *function, const void *input, size_t bytes, double target, struct result *result)
+{
+    size_t calls = 0;
+    size_t allocated = 0;
+    double elapsed = 0;
+    uint64_t cycles = 0;
+
+    do {
+#ifdef COUNT_ALLOCATIONS
+        size_t before = allocations;
+#endif
+        double start = now_seconds();
+        uint64_t start_cycles = now_cycles();
+        void *output = function->run(input);
+        cycles += now_cycles() - start_cycles;
+        elapsed += now_seconds() - start;
+#ifdef COUNT_ALLOCATIONS
+        allocated += allocations - before;
+#endif
+        calls++;
+
+        if (output == NULL) {
+            return false;
+        }
+        free(output);
+    } while (elapsed < target);
+
+    snprintf(result->name, sizeof(result->name), "%s", function->name);
+    result->bytes = bytes;
+    result->megabytes_per_second = (double) bytes * calls / elapsed / 1e6;
+    result->cycles_per_byte = (double) cycles / ((double) bytes * calls);
+    result->allocations_per_call = (double) allocated / calls;
+    return true;
+}
+
+/**
+ * @brief Writes the header of the results in CSV.
+ * @param output Output stream.
+ */
+static void write_header(FILE *output)
+{
+    fprintf(output, "function,bytes,mb_per_s,cycles_per_byte,allocs_per_call\n");
+}
+
+/**
+ * @brief Writes one result in CSV.
+ * @param output Output stream.
+ * @param result Result to be written.
+ */
+static void write_result(FILE *output, const struct result *result)
+{
+    fprintf(output,
+            "%s,%zu,%.2f,%.3f,%.2f\n",
+            result->name,
+            result->bytes,
+            result->megabytes_per_second,
+            result->cycles_per_byte,
+            result->allocations_per_call);
+}
+
+/**
+ * @brief Results loaded from the baseline.
+ */
+struct baseline
+{
+    size_t count;
+    size_t capacity;
+    struct result *results;
+};
+
+/**
+ * @brief Loads the results of the previous run, written by this program.
+ * @param baseline Baseline to be initialized.
+ * @param path Path to the CSV file.
+ * @returns <code>true</code> if the baseline has been loaded, <code>false
+ * </code> otherwise.
+ */
+static bool baseline_load(struct baseline *baseline, const char *path)
+{
+    FILE *input = fopen(path, "r");
+    if (input == NULL) {
+        return false;
+    }
+
+    baseline->count = baseline->capacity = 0;
+    baseline->results = NULL;
+
+    char line[MAX_LINE];
+    while (fgets(line, MAX_LINE, input) != NULL) {
+        struct result result;
+        if (sscanf(line,
+                    "%31[^,],%zu,%lf,%lf,%lf",
+                    result.name,
+                    &result.bytes,
+                    &result.megabytes_per_second,
+                    &result.cycles_per_byte,
+                    &result.allocations_per_call)
+                != 5) {
+            // header and anything else that does not look like a result
+            continue;
+        }
+
+        if (baseline->count == baseline->capacity) {
+            size_t capacity = baseline->capacity == 0 ? 64 : 2 * baseline->capacity;
+            struct result *results = realloc(baseline->results, capacity * sizeof(struct result));
+            if (results == NULL) {
+                free(baseline->results);
+                fclose(input);
+                return false;
+            }
+            baseline->results = results;
+            baseline->capacity = capacity;
+        }
+        baseline->results[baseline->count++] = result;
+    }
+
+    fclose(input);
+    return true;
+}
+
+/**
+ * @brief Finds the result of the same measurement in the baseline.
+ * @param baseline Loaded baseline.
+ * @param result Result of the current run.
+ * @returns Result from the baseline, or <code>NULL</code> if the measurement
+ * is not there.
+ */
+static const struct result *baseline_find(const struct baseline *baseline, const struct result *result)
+{
+    for (size_t i = 0; i < baseline->count; i++) {
+        if (baseline->results[i].bytes == result->bytes && strcmp(baseline->results[i].name, result->name) == 0) {
+            return &baseline->results[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Compares the result with the baseline and reports the regression.
+ * @param baseline Loaded baseline.
+ * @param result Result of the current run.
+ * @param tolerance Allowed slowdown in percents.
+ * @returns <code>true</code> if the result is worse than the baseline,
+ * <code>false</code> otherwise.
+ */
+static bool regressed(const struct baseline *baseline, const struct result *result, double tolerance)
+{
+    const struct result *previous = baseline_find(baseline, result);
+    if (previous == NULL) {
+        return false;
+    }
+
+    bool slower = result->megabytes_per_second < previous->megabytes_per_second * (1 - tolerance / 100);
+    bool allocates = result->allocations_per_call > previous->allocations_per_call;
+    if (slower) {
+        fprintf(stderr,
+                "REGRESSION %s on %zu B: %.2f MB/s, baseline %.2f MB/s (%+.1f %%)\n",
+                result->name,
+                result->bytes,
+                result->megabytes_per_second,
+                previous->megabytes_per_second,
+                100 * (result->megabytes_per_second / previous->megabytes_per_second - 1));
+    }
+    if (allocates) {
+        fprintf(stderr,
+                "REGRESSION %s on %zu B: %.2f allocations per call, baseline %.2f\n",
+                result->name,
+                result->bytes,
+                result->allocations_per_call,
+                previous->allocations_per_call);
+    }
+    return slower || allocates;
+}
+
+/**
+ * @brief Parses size with an optional suffix K, M or G (powers of 1024).
+ * @param text Text to be parsed.
+ * @returns Size in bytes, or 0 if the text is not a valid size.
+ */
+static size_t parse_size(const char *text)
+{
+    char *end;
+    size_t size = strtoul(text, &end, 10);
+    switch (*end) {
+    case 'G':
+        size <<= 10;
+        // fall through
+    case 'M':
+        size <<= 10;
+        // fall through
+    case 'K':
+        size <<= 10;
+        end++;
+        break;
+    }
+    return *end == '\0' ? size : 0;
+}
+
+/**
+ * @brief Options of the program.
+ */
+struct options
+{
+    size_t largest;
+    double target;
+    double tolerance;
+    const char *baseline;
+};
+
+/**
+ * @brief Measures all the functions on the inputs of the given size.
+ * @param options Options of the program.
+ * @param baseline Loaded baseline, or <code>NULL</code>.
+ * @param text Plain text of the given size, terminated by zero.
+ * @param bytes Length of the text.
+ * @param regressions Count of the regressions, incremented.
+ * @returns <code>true</code> if all the functions could be measured, <code>
+ * false</code> otherwise.
+ */
+static bool measure_size(const struct options *options, const struct baseline *baseline, const char *text, size_t bytes, size_t *regressions)
+{
+    bool complete = true;
+
+    for (size_t i = 0; i < FUNCTIONS; i++) {
+        const struct function *function = &functions[i];
+        void *prepared = function->prepare != NULL ? function->prepare(text) : NULL;
+        if (function->prepare != NULL && prepared == NULL) {
+            fprintf(stderr, "Skipping %s, input could not be prepared\n", function->name);
+            complete = false;
+            continue;
+        }
+
+        struct result result;
+        if (!measure(function, prepared != NULL ? prepared : text, bytes, options->target, &result)) {
+            fprintf(stderr, "Skipping %s, it has returned NULL\n", function->name);
+            complete = false;
+        } else {
+            write_result(stdout, &result);
+            fflush(stdout);
+            if (baseline != NULL && regressed(baseline, &result, options->tolerance)) {
+                (*regressions)++;
+            }
+        }
+        free(prepared);
+    }
+
+    return complete;
+}
+
+/**
+ * @brief Main function of a program.
+ * @returns Exit code that denotes following:
+ *      0 in case of success
+ *      1 in case of invalid usage
+ *      2 in case of failure on the baseline or memory allocation
+ *      3 in case some of the functions could not be measured
+ *      4 in case of regression against the baseline
+ */
+int main(int argc, char **argv)
+{
+    struct options options = { DEFAULT_LARGEST, DEFAULT_TARGET, DEFAULT_TOLERANCE, NULL };
+    bool valid = true;
+
+    int option;
+    while ((option = getopt(argc, argv, "m:t:b:r:")) != -1) {
+        switch (option) {
+        case 'm':
+            options.largest = parse_size(optarg);
+            valid = valid && options.largest >= SMALLEST;
+            break;
+        case 't':
+            options.target = strtod(optarg, NULL);
+            break;
+        case 'b':
+            options.baseline = optarg;
+            break;
+        case 'r':
+            options.tolerance = strtod(optarg, NULL);
+            break;
+        default:
+            valid = false;
+            break;
+        }
+    }
+
+    if (!valid || optind != argc) {
+        printf("Usage: %s [-m max-size] [-t seconds] [-b baseline.csv [-r tolerance]]\n", argv[0]);
+        printf("  -m  largest input, suffixes K, M and G are allowed (default 256M, up to 1G)\n");
+        printf("  -t  least time spent measuring each function on each size (default %.1f s)\n", DEFAULT_TARGET);
+        printf("  -b  compare with the results of a previous run\n");
+        printf("  -r  allowed slowdown against the baseline in percents (default %.0f)\n", DEFAULT_TOLERANCE);
+        printf("Results are written to the standard output in CSV, inputs grow from %d B by\n", SMALLEST);
+        printf("the factor of 4, regressions are reported to the standard error.\n");
+        return 1;
+    }
+
+    struct baseline baseline;
+    if (options.baseline != NULL && !baseline_load(&baseline, options.baseline)) {
+        fprintf(stderr, "Could not load the baseline from %s\n", options.baseline);
+        return 2;
+    }
+
+    uint64_t seed = 0x5EED;
+    char *text = malloc(options.largest + 1);
+    if (text == NULL) {
+        fprintf(stderr, "Could not allocate the input\n");
+        if (options.baseline != NULL) {
+            free(baseline.results);
+        }
+        return 2;
+    }
+    fill_text(text, options.largest, &seed);
+
+    bool complete = true;
+    size_t regressions = 0;
+    write_header(stdout);
+
+    for (size_t bytes = SMALLEST; bytes <= options.largest; bytes *= 4) {
+        // all sizes share the same text, it is only cut shorter
+        char saved = text[bytes];
+        text[bytes] = '\0';
+        complete = measure_size(&options, options.baseline != NULL ? &baseline : NULL, text, bytes, &regressions) && complete;
+        text[bytes] = saved;
+    }
+
+    free(text);
+    if (options.baseline != NULL) {
+        free(baseline.results);
+    }
+
+    if (regressions > 0) {
+        fprintf(stderr, "%zu regressions against %s\n", regressions, options.baseline);
+        return 4;
+    }
+    return complete ? 0 : 3;
+}
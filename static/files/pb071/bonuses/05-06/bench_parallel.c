@@ -0,0 +1,79 @@
+#include "bench.h"
+#include "bmp_key.h"
+#include "bmp_parallel.h"
+#include "pool.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define DEFAULT_MEGABYTES 256
+#define DEFAULT_ROUNDS 3
+
+int main(int argc, char **argv)
+{
+    size_t length = (argc > 1 ? strtoul(argv[1], NULL, 10) : DEFAULT_MEGABYTES) << 20;
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t max_threads = argc > 2 ? strtoul(argv[2], NULL, 10) : (online > 0 ? (size_t) online : 1);
+    size_t rounds = argc > 3 ? strtoul(argv[3], NULL, 10) : DEFAULT_ROUNDS;
+    uint64_t seed = 0x5EED;
+
+    struct bmp_key key;
+    char *text = malloc(length);
+    unsigned char *expected = malloc(length);
+    unsigned char *out = malloc(length);
+    if (!bmp_key_init(&key, "CoMPuTeR") || text == NULL || expected == NULL || out == NULL) {
+        fprintf(stderr, "Could not allocate the buffers\n");
+        return 1;
+    }
+    fill_text(text, length, &seed);
+    memset(out, 0, length);
+
+    double start = now_seconds();
+    bmp_key_encrypt(&key, text, length, expected, length);
+    double single = now_seconds() - start;
+
+    printf("%-8s %12s %12s %10s\n", "threads", "enc [GB/s]", "dec [GB/s]", "speedup");
+    printf("%-8s %12.2f %12s %10s\n", "serial", length / single / 1e9, "-", "-");
+
+    int result = 0;
+    double base = 0;
+    for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+        struct thread_pool pool;
+        if (!thread_pool_init(&pool, threads)) {
+            fprintf(stderr, "Could not start the threads\n");
+            result = 1;
+            break;
+        }
+
+        double elapsed[2] = { 0, 0 };
+        for (size_t round = 0; round < rounds; round++) {
+            start = now_seconds();
+            bmp_encrypt_parallel(&pool, &key, BMP_PARALLEL_THRESHOLD, text, length, out, length);
+            elapsed[0] += now_seconds() - start;
+
+            if (memcmp(out, expected, length) != 0) {
+                fprintf(stderr, "Encryption on %zu threads differs from the serial one\n", threads);
+                result = 1;
+            }
+
+            start = now_seconds();
+            bmp_decrypt_parallel(&pool, &key, BMP_PARALLEL_THRESHOLD, out, length, out, length);
+            elapsed[1] += now_seconds() - start;
+        }
+        thread_pool_destroy(&pool);
+
+        if (threads == 1) {
+            base = elapsed[0];
+        }
+        double bytes = (double) length * rounds;
+        printf("%-8zu %12.2f %12.2f %10.2f\n", threads, bytes / elapsed[0] / 1e9, bytes / elapsed[1] / 1e9, base / elapsed[0]);
+    }
+
+    free(out);
+    free(expected);
+    free(text);
+    bmp_key_destroy(&key);
+    return result;
+}
@@ -0,0 +1,66 @@
+#include "bench.h"
+#include "simd.h"
+#include "vigenere_simd.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DEFAULT_MEGABYTES 64
+#define DEFAULT_ROUNDS 5
+
+static const char *level_names[] = { "scalar", "ssse3", "avx2" };
+
+int main(int argc, char **argv)
+{
+    size_t length = (argc > 1 ? strtoul(argv[1], NULL, 10) : DEFAULT_MEGABYTES) << 20;
+    size_t rounds = argc > 2 ? strtoul(argv[2], NULL, 10) : DEFAULT_ROUNDS;
+    const char *key = argc > 3 ? argv[3] : "CoMPuTeR";
+    uint64_t seed = 0x5EED;
+
+    size_t length_of_key;
+    unsigned char *encrypt_table = vigenere_table(key, false, &length_of_key);
+    unsigned char *decrypt_table = vigenere_table(key, true, &length_of_key);
+    char *text = malloc(length);
+    unsigned char *expected = malloc(length);
+    unsigned char *out = malloc(length);
+    if (encrypt_table == NULL || decrypt_table == NULL || text == NULL || expected == NULL || out == NULL) {
+        fprintf(stderr, "Could not allocate the buffers (or the key is invalid)\n");
+        return 1;
+    }
+    fill_text(text, length, &seed);
+    memset(out, 0, length);
+    vigenere_apply(SIMD_SCALAR, encrypt_table, length_of_key, 0, (const unsigned char *) text, length, expected);
+
+    printf("%-8s %12s %12s\n", "kernel", "enc [GB/s]", "dec [GB/s]");
+
+    int result = 0;
+    for (int level = SIMD_SCALAR; level <= (int) simd_detect(); level++) {
+        double elapsed[2] = { 0, 0 };
+
+        for (size_t round = 0; round < rounds; round++) {
+            double start = now_seconds();
+            vigenere_apply(level, encrypt_table, length_of_key, 0, (const unsigned char *) text, length, out);
+            elapsed[0] += now_seconds() - start;
+
+            if (memcmp(out, expected, length) != 0) {
+                fprintf(stderr, "%s kernel differs from the scalar one\n", level_names[level]);
+                result = 1;
+            }
+
+            start = now_seconds();
+            vigenere_apply(level, decrypt_table, length_of_key, 0, out, length, out);
+            elapsed[1] += now_seconds() - start;
+        }
+
+        double bytes = (double) length * rounds;
+        printf("%-8s %12.2f %12.2f\n", level_names[level], bytes / elapsed[0] / 1e9, bytes / elapsed[1] / 1e9);
+    }
+
+    free(out);
+    free(expected);
+    free(text);
+    free(decrypt_table);
+    free(encrypt_table);
+    return result;
+}
@@ -0,0 +1,143 @@
+#include "bit_simd.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef HAVE_SIMD_KERNELS
+#include <immintrin.h>
+#endif
+
+const unsigned char bit_encrypt_table[256] = {
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f,
+    0x22, 0x23, 0x20, 0x21, 0x26, 0x27, 0x24, 0x25, 0x2a, 0x2b, 0x28, 0x29, 0x2e, 0x2f, 0x2c, 0x2d,
+    0x11, 0x10, 0x13, 0x12, 0x15, 0x14, 0x17, 0x16, 0x19, 0x18, 0x1b, 0x1a, 0x1d, 0x1c, 0x1f, 0x1e,
+    0x33, 0x32, 0x31, 0x30, 0x37, 0x36, 0x35, 0x34, 0x3b, 0x3a, 0x39, 0x38, 0x3f, 0x3e, 0x3d, 0x3c,
+    0x88, 0x89, 0x8a, 0x8b, 0x8c, 0x8d, 0x8e, 0x8f, 0x80, 0x81, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87,
+    0xaa, 0xab, 0xa8, 0xa9, 0xae, 0xaf, 0xac, 0xad, 0xa2, 0xa3, 0xa0, 0xa1, 0xa6, 0xa7, 0xa4, 0xa5,
+    0x99, 0x98, 0x9b, 0x9a, 0x9d, 0x9c, 0x9f, 0x9e, 0x91, 0x90, 0x93, 0x92, 0x95, 0x94, 0x97, 0x96,
+    0xbb, 0xba, 0xb9, 0xb8, 0xbf, 0xbe, 0xbd, 0xbc, 0xb3, 0xb2, 0xb1, 0xb0, 0xb7, 0xb6, 0xb5, 0xb4,
+    0x44, 0x45, 0x46, 0x47, 0x40, 0x41, 0x42, 0x43, 0x4c, 0x4d, 0x4e, 0x4f, 0x48, 0x49, 0x4a, 0x4b,
+    0x66, 0x67, 0x64, 0x65, 0x62, 0x63, 0x60, 0x61, 0x6e, 0x6f, 0x6c, 0x6d, 0x6a, 0x6b, 0x68, 0x69,
+    0x55, 0x54, 0x57, 0x56, 0x51, 0x50, 0x53, 0x52, 0x5d, 0x5c, 0x5f, 0x5e, 0x59, 0x58, 0x5b, 0x5a,
+    0x77, 0x76, 0x75, 0x74, 0x73, 0x72, 0x71, 0x70, 0x7f, 0x7e, 0x7d, 0x7c, 0x7b, 0x7a, 0x79, 0x78,
+    0xcc, 0xcd, 0xce, 0xcf, 0xc8, 0xc9, 0xca, 0xcb, 0xc4, 0xc5, 0xc6, 0xc7, 0xc0, 0xc1, 0xc2, 0xc3,
+    0xee, 0xef, 0xec, 0xed, 0xea, 0xeb, 0xe8, 0xe9, 0xe6, 0xe7, 0xe4, 0xe5, 0xe2, 0xe3, 0xe0, 0xe1,
+    0xdd, 0xdc, 0xdf, 0xde, 0xd9, 0xd8, 0xdb, 0xda, 0xd5, 0xd4, 0xd7, 0xd6, 0xd1, 0xd0, 0xd3, 0xd2,
+    0xff, 0xfe, 0xfd, 0xfc, 0xfb, 0xfa, 0xf9, 0xf8, 0xf7, 0xf6, 0xf5, 0xf4, 0xf3, 0xf2, 0xf1, 0xf0,
+};
+
+const unsigned char bit_decrypt_table[256] = {
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f,
+    0x21, 0x20, 0x23, 0x22, 0x25, 0x24, 0x27, 0x26, 0x29, 0x28, 0x2b, 0x2a, 0x2d, 0x2c, 0x2f, 0x2e,
+    0x12, 0x13, 0x10, 0x11, 0x16, 0x17, 0x14, 0x15, 0x1a, 0x1b, 0x18, 0x19, 0x1e, 0x1f, 0x1c, 0x1d,
+    0x33, 0x32, 0x31, 0x30, 0x37, 0x36, 0x35, 0x34, 0x3b, 0x3a, 0x39, 0x38, 0x3f, 0x3e, 0x3d, 0x3c,
+    0x84, 0x85, 0x86, 0x87, 0x80, 0x81, 0x82, 0x83, 0x8c, 0x8d, 0x8e, 0x8f, 0x88, 0x89, 0x8a, 0x8b,
+    0xa5, 0xa4, 0xa7, 0xa6, 0xa1, 0xa0, 0xa3, 0xa2, 0xad, 0xac, 0xaf, 0xae, 0xa9, 0xa8, 0xab, 0xaa,
+    0x96, 0x97, 0x94, 0x95, 0x92, 0x93, 0x90, 0x91, 0x9e, 0x9f, 0x9c, 0x9d, 0x9a, 0x9b, 0x98, 0x99,
+    0xb7, 0xb6, 0xb5, 0xb4, 0xb3, 0xb2, 0xb1, 0xb0, 0xbf, 0xbe, 0xbd, 0xbc, 0xbb, 0xba, 0xb9, 0xb8,
+    0x48, 0x49, 0x4a, 0x4b, 0x4c, 0x4d, 0x4e, 0x4f, 0x40, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47,
+    0x69, 0x68, 0x6b, 0x6a, 0x6d, 0x6c, 0x6f, 0x6e, 0x61, 0x60, 0x63, 0x62, 0x65, 0x64, 0x67, 0x66,
+    0x5a, 0x5b, 0x58, 0x59, 0x5e, 0x5f, 0x5c, 0x5d, 0x52, 0x53, 0x50, 0x51, 0x56, 0x57, 0x54, 0x55,
+    0x7b, 0x7a, 0x79, 0x78, 0x7f, 0x7e, 0x7d, 0x7c, 0x73, 0x72, 0x71, 0x70, 0x77, 0x76, 0x75, 0x74,
+    0xcc, 0xcd, 0xce, 0xcf, 0xc8, 0xc9, 0xca, 0xcb, 0xc4, 0xc5, 0xc6, 0xc7, 0xc0, 0xc1, 0xc2, 0xc3,
+    0xed, 0xec, 0xef, 0xee, 0xe9, 0xe8, 0xeb, 0xea, 0xe5, 0xe4, 0xe7, 0xe6, 0xe1, 0xe0, 0xe3, 0xe2,
+    0xde, 0xdf, 0xdc, 0xdd, 0xda, 0xdb, 0xd8, 0xd9, 0xd6, 0xd7, 0xd4, 0xd5, 0xd2, 0xd3, 0xd0, 0xd1,
+    0xff, 0xfe, 0xfd, 0xfc, 0xfb, 0xfa, 0xf9, 0xf8, 0xf7, 0xf6, 0xf5, 0xf4, 0xf3, 0xf2, 0xf1, 0xf0,
+};
+
+static void apply_table(const unsigned char *table, const unsigned char *in, size_t length, unsigned char *out)
+{
+    for (size_t i = 0; i < length; i++) {
+        out[i] = table[in[i]];
+    }
+}
+
+#ifdef HAVE_SIMD_KERNELS
+
+/*
+ * Result of both transforms is (f(h) << 4 | g(h)) ^ l for the upper nibble h
+ * and lower nibble l of the byte, where f and g are:
+ *  - encryption: f(h) = g(h) = h with swapped pairs of bits,
+ *  - decryption: f(h) = h with swapped pairs of bits, g(h) = h.
+ * Upper half of the result is looked up by a single shuffle.
+ */
+static const unsigned char encrypt_nibbles[16] = { 0x00, 0x22, 0x11, 0x33, 0x88, 0xaa, 0x99, 0xbb, 0x44, 0x66, 0x55, 0x77, 0xcc, 0xee, 0xdd, 0xff };
+static const unsigned char decrypt_nibbles[16] = { 0x00, 0x21, 0x12, 0x33, 0x84, 0xa5, 0x96, 0xb7, 0x48, 0x69, 0x5a, 0x7b, 0xcc, 0xed, 0xde, 0xff };
+
+__attribute__((target("ssse3"))) static void apply_ssse3(bool decrypt, const unsigned char *in, size_t length, unsigned char *out)
+{
+    const __m128i nibbles = _mm_loadu_si128((const __m128i *) (decrypt ? decrypt_nibbles : encrypt_nibbles));
+    const __m128i low_nibble = _mm_set1_epi8(0x0F);
+
+    size_t i = 0;
+    for (; i + 16 <= length; i += 16) {
+        __m128i c = _mm_loadu_si128((const __m128i *) (in + i));
+        __m128i high = _mm_and_si128(_mm_srli_epi16(c, 4), low_nibble);
+        __m128i result = _mm_xor_si128(_mm_shuffle_epi8(nibbles, high), _mm_and_si128(c, low_nibble));
+        _mm_storeu_si128((__m128i *) (out + i), result);
+    }
+
+    apply_table(decrypt ? bit_decrypt_table : bit_encrypt_table, in + i, length - i, out + i);
+}
+
+__attribute__((target("avx2"))) static void apply_avx2(bool decrypt, const unsigned char *in, size_t length, unsigned char *out)
+{
+    const __m256i nibbles = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *) (decrypt ? decrypt_nibbles : encrypt_nibbles)));
+    const __m256i low_nibble = _mm256_set1_epi8(0x0F);
+
+    size_t i = 0;
+    for (; i + 32 <= length; i += 32) {
+        __m256i c = _mm256_loadu_si256((const __m256i *) (in + i));
+        __m256i high = _mm256_and_si256(_mm256_srli_epi16(c, 4), low_nibble);
+        __m256i result = _mm256_xor_si256(_mm256_shuffle_epi8(nibbles, high), _mm256_and_si256(c, low_nibble));
+        _mm256_storeu_si256((__m256i *) (out + i), result);
+    }
+
+    apply_table(decrypt ? bit_decrypt_table : bit_encrypt_table, in + i, length - i, out + i);
+}
+
+#endif
+
+void bit_apply(enum simd_level_t level, bool decrypt, const unsigned char *in, size_t length, unsigned char *out)
+{
+#ifdef HAVE_SIMD_KERNELS
+    switch (simd_supported(level)) {
+    case SIMD_AVX2:
+        apply_avx2(decrypt, in, length, out);
+        return;
+    case SIMD_SSSE3:
+        apply_ssse3(decrypt, in, length, out);
+        return;
+    default:
+        break;
+    }
+#else
+    (void) level;
+#endif
+    apply_table(decrypt ? bit_decrypt_table : bit_encrypt_table, in, length, out);
+}
+
+static unsigned char *bit(const unsigned char *text, bool decrypt)
+{
+    if (text == NULL) {
+        return NULL;
+    }
+
+    size_t length = strlen((const char *) text);
+    unsigned char *result = malloc(length + 1);
+    if (result != NULL) {
+        bit_apply(SIMD_AVX2, decrypt, text, length, result);
+        result[length] = '\0';
+    }
+    return result;
+}
+
+unsigned char *bit_encrypt_simd(const char *text)
+{
+    return bit((const unsigned char *) text, false);
+}
+
+char *bit_decrypt_simd(const unsigned char *text)
+{
+    return (char *) bit(text, true);
+}
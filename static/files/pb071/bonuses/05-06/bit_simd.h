@@ -0,0 +1,46 @@
+#ifndef _BIT_SIMD_H
+#define _BIT_SIMD_H
+
+#include "simd.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * Bitwise encryption of each byte, the transform is a bijection on bytes.
+ */
+extern const unsigned char bit_encrypt_table[256];
+
+/**
+ * Inverse of <code>bit_encrypt_table</code>.
+ */
+extern const unsigned char bit_decrypt_table[256];
+
+/**
+ * @brief Applies the bitwise encryption (or decryption) on the block of bytes.
+ *
+ * Scalar kernel looks the bytes up in the tables, vectorized kernels shuffle
+ * the upper nibbles of 16 (SSSE3) or 32 (AVX2) bytes at once; lower nibble is
+ * only XORed with the result of the shuffle.
+ *
+ * @param level Instruction set to be used, it is limited to the ones supported
+ * by the CPU.
+ * @param decrypt Whether the bytes are decrypted instead.
+ * @param in Block of the bytes.
+ * @param length Length of the block.
+ * @param out Output buffer of <code>length</code> bytes, can be the same as the
+ * input.
+ */
+void bit_apply(enum simd_level_t level, bool decrypt, const unsigned char *in, size_t length, unsigned char *out);
+
+/**
+ * Same as bit_encrypt() but the fastest kernel supported by the CPU is used.
+ */
+unsigned char *bit_encrypt_simd(const char *text);
+
+/**
+ * Same as bit_decrypt() but the fastest kernel supported by the CPU is used.
+ */
+char *bit_decrypt_simd(const unsigned char *text);
+
+#endif
@@ -0,0 +1,181 @@
+#include "bmp_key.h"
+
+#include "bit_simd.h"
+#include "bmp_n.h"
+#include "cipher.h"
+#include "reverse_simd.h"
+#include "simd.h"
+#include "vigenere_simd.h"
+
+#include <stdlib.h>
+
+bool bmp_key_init(struct bmp_key *key, const char *word)
+{
+    if (!key_length(word, &key->length)) {
+        return false;
+    }
+
+    // both tables share one allocation
+    size_t size = key->length + VIGENERE_PADDING;
+    key->storage = malloc(2 * size);
+    if (key->storage == NULL) {
+        return false;
+    }
+
+    vigenere_table_fill(word, key->length, false, key->storage);
+    vigenere_table_fill(word, key->length, true, key->storage + size);
+    key->encrypt = key->storage;
+    key->decrypt = key->storage + size;
+    return true;
+}
+
+void bmp_key_destroy(struct bmp_key *key)
+{
+    free(key->storage);
+    key->storage = NULL;
+    key->encrypt = key->decrypt = NULL;
+}
+
+static size_t encrypt_part(enum simd_level_t level, const struct bmp_key *key, size_t offset, const unsigned char *text, size_t length, unsigned char *encrypted)
+{
+    for (size_t i = 0; i < length; i += BMP_KEY_BLOCK) {
+        size_t size = length - i < BMP_KEY_BLOCK ? length - i : BMP_KEY_BLOCK;
+        reverse_apply(level, text + length - i - size, size, encrypted + i);
+        offset = vigenere_apply(level, key->encrypt, key->length, offset, encrypted + i, size, encrypted + i);
+        bit_apply(level, false, encrypted + i, size, encrypted + i);
+    }
+    return offset;
+}
+
+static size_t decrypt_part(enum simd_level_t level, const struct bmp_key *key, size_t offset, const unsigned char *text, size_t length, unsigned char *decrypted)
+{
+    // each block is decrypted into the temporary buffer and then reversed
+    // into its place
+    unsigned char block[BMP_KEY_BLOCK];
+    for (size_t i = 0; i < length; i += BMP_KEY_BLOCK) {
+        size_t size = length - i < BMP_KEY_BLOCK ? length - i : BMP_KEY_BLOCK;
+        bit_apply(level, true, text + i, size, block);
+        offset = vigenere_apply(level, key->decrypt, key->length, offset, block, size, block);
+        reverse_apply(level, block, size, decrypted + length - i - size);
+    }
+    return offset;
+}
+
+static void encrypt(enum simd_level_t level, const struct bmp_key *key, const unsigned char *text, size_t length, unsigned char *encrypted)
+{
+    if (text != encrypted) {
+        encrypt_part(level, key, 0, text, length, encrypted);
+        return;
+    }
+
+    // block cannot be reversed into its place without overwriting the input
+    // that is yet to be read, whole text is reversed beforehand instead
+    reverse_apply(level, text, length, encrypted);
+    size_t offset = 0;
+    for (size_t i = 0; i < length; i += BMP_KEY_BLOCK) {
+        size_t size = length - i < BMP_KEY_BLOCK ? length - i : BMP_KEY_BLOCK;
+        offset = vigenere_apply(level, key->encrypt, key->length, offset, encrypted + i, size, encrypted + i);
+        bit_apply(level, false, encrypted + i, size, encrypted + i);
+    }
+}
+
+static void decrypt(enum simd_level_t level, const struct bmp_key *key, const unsigned char *text, size_t length, unsigned char *decrypted)
+{
+    if (text != decrypted) {
+        decrypt_part(level, key, 0, text, length, decrypted);
+        return;
+    }
+
+    size_t offset = 0;
+    for (size_t i = 0; i < length; i += BMP_KEY_BLOCK) {
+        size_t size = length - i < BMP_KEY_BLOCK ? length - i : BMP_KEY_BLOCK;
+        bit_apply(level, true, decrypted + i, size, decrypted + i);
+        offset = vigenere_apply(level, key->decrypt, key->length, offset, decrypted + i, size, decrypted + i);
+    }
+    reverse_apply(level, decrypted, length, decrypted);
+}
+
+size_t bmp_key_encrypt_part(const struct bmp_key *key, size_t offset, const unsigned char *in, size_t length, unsigned char *out)
+{
+    return encrypt_part(simd_detect(), key, offset, in, length, out);
+}
+
+size_t bmp_key_decrypt_part(const struct bmp_key *key, size_t offset, const unsigned char *in, size_t length, unsigned char *out)
+{
+    return decrypt_part(simd_detect(), key, offset, in, length, out);
+}
+
+size_t bmp_key_encrypt(const struct bmp_key *key, const void *in, size_t length, void *out, size_t out_cap)
+{
+    if (!check_buffers_n(in, length, out, out_cap)) {
+        return BMP_N_ERROR;
+    }
+
+    encrypt(simd_detect(), key, in, length, out);
+    return length;
+}
+
+size_t bmp_key_decrypt(const struct bmp_key *key, const void *in, size_t length, void *out, size_t out_cap)
+{
+    if (!check_buffers_n(in, length, out, out_cap)) {
+        return BMP_N_ERROR;
+    }
+
+    decrypt(simd_detect(), key, in, length, out);
+    return length;
+}
+
+size_t bmp_key_vigenere_encrypt(const struct bmp_key *key, const void *in, size_t length, void *out, size_t out_cap)
+{
+    if (!check_buffers_n(in, length, out, out_cap)) {
+        return BMP_N_ERROR;
+    }
+
+    vigenere_apply(SIMD_AVX2, key->encrypt, key->length, 0, in, length, out);
+    return length;
+}
+
+size_t bmp_key_vigenere_decrypt(const struct bmp_key *key, const void *in, size_t length, void *out, size_t out_cap)
+{
+    if (!check_buffers_n(in, length, out, out_cap)) {
+        return BMP_N_ERROR;
+    }
+
+    vigenere_apply(SIMD_AVX2, key->decrypt, key->length, 0, in, length, out);
+    return length;
+}
+
+static size_t batch(const struct bmp_key *key, struct bmp_message *messages, size_t count, bool decrypting)
+{
+    // instruction set is detected once for the whole batch
+    enum simd_level_t level = simd_detect();
+    size_t successful = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        struct bmp_message *message = &messages[i];
+        if (!check_buffers_n(message->in, message->length, message->out, message->out_cap)) {
+            message->written = BMP_N_ERROR;
+            continue;
+        }
+
+        if (decrypting) {
+            decrypt(level, key, message->in, message->length, message->out);
+        } else {
+            encrypt(level, key, message->in, message->length, message->out);
+        }
+        message->written = message->length;
+        successful++;
+    }
+
+    return successful;
+}
+
+size_t bmp_encrypt_batch(const struct bmp_key *key, struct bmp_message *messages, size_t count)
+{
+    return batch(key, messages, count, false);
+}
+
+size_t bmp_decrypt_batch(const struct bmp_key *key, struct bmp_message *messages, size_t count)
+{
+    return batch(key, messages, count, true);
+}
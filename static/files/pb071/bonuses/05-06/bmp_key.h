@@ -0,0 +1,128 @@
+#ifndef _BMP_KEY_H
+#define _BMP_KEY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * Count of the bytes that are processed by all the stages at once, so that
+ * the block stays in the L1 cache between them.
+ */
+#define BMP_KEY_BLOCK 4096
+
+/**
+ * Key of the BMP cipher compiled once and used for any number of messages; it
+ * is validated and expanded into the tables of shifts used by the vectorized
+ * kernels only when it is created.
+ */
+struct bmp_key
+{
+    /** Length of the key. */
+    size_t length;
+    /** Shifts of the letters for encryption, key is repeated so that a whole
+     * vector of shifts can be loaded from any position within the key. */
+    const unsigned char *encrypt;
+    /** Complemented shifts for decryption, repeated the same way. */
+    const unsigned char *decrypt;
+    /** Memory holding the tables, <code>NULL</code> if they are borrowed. */
+    unsigned char *storage;
+};
+
+/**
+ * @brief Compiles the key.
+ * @param key Key to be initialized.
+ * @param word Single case-insensitive word consisting of only alphabetical
+ * characters.
+ * @returns <code>true</code> if the key has been compiled, <code>false</code> if
+ * the word is not a valid key or the memory could not be allocated.
+ */
+bool bmp_key_init(struct bmp_key *key, const char *word);
+
+/**
+ * @brief Frees the memory held by the key.
+ * @param key Key to be destroyed.
+ */
+void bmp_key_destroy(struct bmp_key *key);
+
+/**
+ * Encrypts the input by the BMP cipher with the compiled key, see
+ * bmp_encrypt_n() for the description of the buffers.
+ *
+ * @return count of the bytes written to the output, or BMP_N_ERROR if the
+ * output buffer is too small.
+ */
+size_t bmp_key_encrypt(const struct bmp_key *key, const void *in, size_t length, void *out, size_t out_cap);
+
+/**
+ * Decrypts the input by the BMP cipher with the compiled key, see
+ * bmp_key_encrypt().
+ */
+size_t bmp_key_decrypt(const struct bmp_key *key, const void *in, size_t length, void *out, size_t out_cap);
+
+/**
+ * Encrypts one part of the message, the output is the corresponding part of
+ * the ciphertext, i.e. the part of the reversed message. Parts can be encrypted
+ * independently (and in any order) given the positions in the key.
+ *
+ * @param key compiled key
+ * @param offset position in the key where the part of the ciphertext starts,
+ * i.e. count of the letters that follow the part in the message modulo the
+ * length of the key
+ * @param in part of the message
+ * @param length length of the part
+ * @param out output buffer of length bytes, not overlapping with the input
+ * @return position in the key after the part
+ */
+size_t bmp_key_encrypt_part(const struct bmp_key *key, size_t offset, const unsigned char *in, size_t length, unsigned char *out);
+
+/**
+ * Decrypts one part of the ciphertext into the corresponding part of the
+ * message (reversed), see bmp_key_encrypt_part().
+ *
+ * @param offset position in the key where the part of the ciphertext starts,
+ * i.e. count of the letters that precede the part in the ciphertext (after the
+ * bitwise decryption) modulo the length of the key
+ */
+size_t bmp_key_decrypt_part(const struct bmp_key *key, size_t offset, const unsigned char *in, size_t length, unsigned char *out);
+
+/**
+ * Encrypts the input by the Vigenère cipher with the compiled key, see
+ * bmp_key_encrypt().
+ */
+size_t bmp_key_vigenere_encrypt(const struct bmp_key *key, const void *in, size_t length, void *out, size_t out_cap);
+
+/**
+ * Decrypts the input by the Vigenère cipher with the compiled key, see
+ * bmp_key_encrypt().
+ */
+size_t bmp_key_vigenere_decrypt(const struct bmp_key *key, const void *in, size_t length, void *out, size_t out_cap);
+
+/**
+ * One message of the batch.
+ */
+struct bmp_message
+{
+    const void *in;
+    size_t length;
+    void *out;
+    size_t out_cap;
+    /** Set by the batch to the count of the bytes written, or BMP_N_ERROR. */
+    size_t written;
+};
+
+/**
+ * Encrypts all the messages with the same key.
+ *
+ * @param key compiled key
+ * @param messages messages to be encrypted
+ * @param count count of the messages
+ * @return count of the messages that have been encrypted successfully.
+ */
+size_t bmp_encrypt_batch(const struct bmp_key *key, struct bmp_message *messages, size_t count);
+
+/**
+ * Decrypts all the messages with the same key, see bmp_encrypt_batch().
+ */
+size_t bmp_decrypt_batch(const struct bmp_key *key, struct bmp_message *messages, size_t count);
+
+#endif
@@ -0,0 +1,119 @@
+#include "bmp_n.h"
+
+#include "bit_simd.h"
+#include "bmp_key.h"
+#include "cipher.h"
+#include "reverse_simd.h"
+#include "simd.h"
+#include "vigenere_simd.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+/** Longest key whose table of shifts is kept on the stack. */
+#define STACK_KEY 480
+
+/**
+ * @brief Key compiled for a single call, its table of shifts is kept on the
+ * stack unless the key is very long. Only the table for the requested
+ * direction is filled.
+ */
+struct stack_key
+{
+    struct bmp_key key;
+    unsigned char stack[STACK_KEY + VIGENERE_PADDING];
+};
+
+static bool stack_key_init(struct stack_key *stack_key, const char *word, bool decrypt)
+{
+    struct bmp_key *key = &stack_key->key;
+    if (!key_length(word, &key->length)) {
+        return false;
+    }
+
+    unsigned char *table = key->length <= STACK_KEY ? stack_key->stack : malloc(key->length + VIGENERE_PADDING);
+    if (table == NULL) {
+        return false;
+    }
+
+    vigenere_table_fill(word, key->length, decrypt, table);
+    key->encrypt = key->decrypt = table;
+    key->storage = table == stack_key->stack ? NULL : table;
+    return true;
+}
+
+bool check_buffers_n(const void *in, size_t length, const void *out, size_t out_cap)
+{
+    return length == 0 || (in != NULL && out != NULL && out_cap >= length);
+}
+
+size_t reverse_n(const void *in, size_t length, void *out, size_t out_cap)
+{
+    if (!check_buffers_n(in, length, out, out_cap)) {
+        return BMP_N_ERROR;
+    }
+
+    reverse_apply(SIMD_AVX2, in, length, out);
+    return length;
+}
+
+/**
+ * @brief Compiles the key on the stack and calls the given function with it.
+ */
+static size_t with_key(const char *word,
+        bool decrypt,
+        size_t (*function)(const struct bmp_key *, const void *, size_t, void *, size_t),
+        const void *in,
+        size_t length,
+        void *out,
+        size_t out_cap)
+{
+    struct stack_key stack_key;
+    if (!stack_key_init(&stack_key, word, decrypt)) {
+        return BMP_N_ERROR;
+    }
+
+    size_t written = function(&stack_key.key, in, length, out, out_cap);
+    bmp_key_destroy(&stack_key.key);
+    return written;
+}
+
+size_t vigenere_encrypt_n(const char *key, const void *in, size_t length, void *out, size_t out_cap)
+{
+    return with_key(key, false, bmp_key_vigenere_encrypt, in, length, out, out_cap);
+}
+
+size_t vigenere_decrypt_n(const char *key, const void *in, size_t length, void *out, size_t out_cap)
+{
+    return with_key(key, true, bmp_key_vigenere_decrypt, in, length, out, out_cap);
+}
+
+size_t bit_encrypt_n(const void *in, size_t length, void *out, size_t out_cap)
+{
+    if (!check_buffers_n(in, length, out, out_cap)) {
+        return BMP_N_ERROR;
+    }
+
+    bit_apply(SIMD_AVX2, false, in, length, out);
+    return length;
+}
+
+size_t bit_decrypt_n(const void *in, size_t length, void *out, size_t out_cap)
+{
+    if (!check_buffers_n(in, length, out, out_cap)) {
+        return BMP_N_ERROR;
+    }
+
+    bit_apply(SIMD_AVX2, true, in, length, out);
+    return length;
+}
+
+size_t bmp_encrypt_n(const char *key, const void *in, size_t length, void *out, size_t out_cap)
+{
+    return with_key(key, false, bmp_key_encrypt, in, length, out, out_cap);
+}
+
+size_t bmp_decrypt_n(const char *key, const void *in, size_t length, void *out, size_t out_cap)
+{
+    return with_key(key, true, bmp_key_decrypt, in, length, out, out_cap);
+}
@@ -0,0 +1,94 @@
+#ifndef _BMP_N_H
+#define _BMP_N_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+ * Variants of the functions from bmp.h that take the length of the input
+ * instead of relying on the terminating zero and write into the buffer given by
+ * the caller instead of allocating a new one. The output is not terminated by
+ * zero, input can contain zero bytes.
+ *
+ * Output can be the same buffer as the input (in-place operation), other
+ * overlaps of the buffers are not allowed.
+ */
+
+/**
+ * Returned by the functions below if the operation was not successful.
+ */
+#define BMP_N_ERROR ((size_t) -1)
+
+/**
+ * Checks the buffers given to the functions below.
+ *
+ * @param in input bytes
+ * @param length count of the input bytes
+ * @param out output buffer
+ * @param out_cap capacity of the output buffer
+ * @return true if there is nothing to be processed or both buffers are given
+ * and the output is big enough, false otherwise.
+ */
+bool check_buffers_n(const void *in, size_t length, const void *out, size_t out_cap);
+
+/**
+ * Reverses and uppercases the input, see reverse().
+ *
+ * @param in input bytes
+ * @param length count of the input bytes
+ * @param out output buffer
+ * @param out_cap capacity of the output buffer
+ * @return count of the bytes written to the output, or BMP_N_ERROR if the
+ * output buffer is too small.
+ */
+size_t reverse_n(const void *in, size_t length, void *out, size_t out_cap);
+
+/**
+ * Encrypts the input by the Vigenère cipher, see vigenere_encrypt().
+ *
+ * @param key Key which will be used for encrypting the plaintext, single
+ * case-insensitive word consisting of only alphabetical characters.
+ * @param in input bytes
+ * @param length count of the input bytes
+ * @param out output buffer
+ * @param out_cap capacity of the output buffer
+ * @return count of the bytes written to the output, or BMP_N_ERROR if the key
+ * is invalid or the output buffer is too small.
+ */
+size_t vigenere_encrypt_n(const char *key, const void *in, size_t length, void *out, size_t out_cap);
+
+/**
+ * Decrypts the input by the Vigenère cipher, see vigenere_decrypt(). Parameters
+ * and the return value are the same as for vigenere_encrypt_n().
+ */
+size_t vigenere_decrypt_n(const char *key, const void *in, size_t length, void *out, size_t out_cap);
+
+/**
+ * Encrypts the input by the bitwise encryption, see bit_encrypt(). Parameters
+ * and the return value are the same as for reverse_n().
+ */
+size_t bit_encrypt_n(const void *in, size_t length, void *out, size_t out_cap);
+
+/**
+ * Decrypts the input by the bitwise decryption, see bit_decrypt(). Parameters
+ * and the return value are the same as for reverse_n().
+ */
+size_t bit_decrypt_n(const void *in, size_t length, void *out, size_t out_cap);
+
+/**
+ * Encrypts the input by the BMP cipher, see bmp_encrypt(). Parameters and the
+ * return value are the same as for vigenere_encrypt_n().
+ *
+ * Input is processed in blocks that fit into the L1 cache; each block is
+ * reversed into its final position and then encrypted in place, so the output
+ * is written only once.
+ */
+size_t bmp_encrypt_n(const char *key, const void *in, size_t length, void *out, size_t out_cap);
+
+/**
+ * Decrypts the input by the BMP cipher, see bmp_decrypt(). Parameters and the
+ * return value are the same as for vigenere_encrypt_n().
+ */
+size_t bmp_decrypt_n(const char *key, const void *in, size_t length, void *out, size_t out_cap);
+
+#endif
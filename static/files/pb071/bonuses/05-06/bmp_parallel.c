@@ -0,0 +1,203 @@
+#include "bmp_parallel.h"
+
+#include "bit_simd.h"
+#include "bmp_n.h"
+#include "reverse_simd.h"
+#include "simd.h"
+#include "vigenere_simd.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+/** Chunks are at least this big, so that the overhead of the tasks is negligible. */
+#define MIN_CHUNK (16 * BMP_KEY_BLOCK)
+#define MAX_CHUNKS 256
+/** Count of the chunks per thread, so that faster threads can take more. */
+#define CHUNKS_PER_THREAD 4
+
+/**
+ * @brief Shared state of one parallel encryption or decryption.
+ */
+struct job
+{
+    const struct bmp_key *key;
+    enum simd_level_t level;
+    bool decrypting;
+    bool in_place;
+
+    const unsigned char *in;
+    unsigned char *out;
+    size_t length;
+
+    size_t chunk;
+    size_t chunks;
+    /** Count of the letters in each chunk, later turned into the position in
+     * the key where the chunk starts. */
+    size_t offsets[MAX_CHUNKS];
+};
+
+static size_t chunk_end(const struct job *job, size_t index)
+{
+    size_t end = (index + 1) * job->chunk;
+    return end < job->length ? end : job->length;
+}
+
+/**
+ * @brief Swaps the chunk of the first half of the output with its mirror in the
+ * second half, both are reversed, so that the whole output gets reversed.
+ */
+static void reverse_task(void *context, size_t index)
+{
+    struct job *job = context;
+    unsigned char saved[BMP_KEY_BLOCK];
+
+    size_t half = job->length / 2;
+    size_t end = (index + 1) * job->chunk < half ? (index + 1) * job->chunk : half;
+
+    for (size_t start = index * job->chunk; start < end; start += BMP_KEY_BLOCK) {
+        size_t size = end - start < BMP_KEY_BLOCK ? end - start : BMP_KEY_BLOCK;
+        unsigned char *front = job->out + start;
+        unsigned char *back = job->out + job->length - start - size;
+
+        memcpy(saved, front, size);
+        reverse_apply(job->level, back, size, front);
+        reverse_apply(job->level, saved, size, back);
+    }
+}
+
+/**
+ * @brief Counts the letters of the chunk in the order the key is applied.
+ */
+static void count_task(void *context, size_t index)
+{
+    struct job *job = context;
+    size_t start = index * job->chunk, end = chunk_end(job, index);
+    size_t letters = 0;
+
+    if (!job->decrypting) {
+        // chunk of the ciphertext comes from the mirrored part of the input,
+        // unless the input has already been reversed in place
+        const unsigned char *text = job->in_place ? job->out + start : job->in + job->length - end;
+        letters = count_letters(job->level, text, end - start);
+    } else {
+        // letters are known only after the bitwise decryption
+        unsigned char block[BMP_KEY_BLOCK];
+        for (size_t i = start; i < end; i += BMP_KEY_BLOCK) {
+            size_t size = end - i < BMP_KEY_BLOCK ? end - i : BMP_KEY_BLOCK;
+            bit_apply(job->level, true, job->in + i, size, block);
+            letters += count_letters(job->level, block, size);
+        }
+    }
+
+    job->offsets[index] = letters;
+}
+
+static void apply_task(void *context, size_t index)
+{
+    struct job *job = context;
+    size_t start = index * job->chunk, end = chunk_end(job, index);
+    size_t offset = job->offsets[index];
+
+    if (!job->in_place) {
+        if (job->decrypting) {
+            bmp_key_decrypt_part(job->key, offset, job->in + start, end - start, job->out + job->length - end);
+        } else {
+            bmp_key_encrypt_part(job->key, offset, job->in + job->length - end, end - start, job->out + start);
+        }
+        return;
+    }
+
+    for (size_t i = start; i < end; i += BMP_KEY_BLOCK) {
+        size_t size = end - i < BMP_KEY_BLOCK ? end - i : BMP_KEY_BLOCK;
+        unsigned char *block = job->out + i;
+
+        if (job->decrypting) {
+            bit_apply(job->level, true, block, size, block);
+            offset = vigenere_apply(job->level, job->key->decrypt, job->key->length, offset, block, size, block);
+        } else {
+            offset = vigenere_apply(job->level, job->key->encrypt, job->key->length, offset, block, size, block);
+            bit_apply(job->level, false, block, size, block);
+        }
+    }
+}
+
+static void reverse_in_place(struct thread_pool *pool, struct job *job)
+{
+    size_t half = job->length / 2;
+    thread_pool_run(pool, reverse_task, job, (half + job->chunk - 1) / job->chunk);
+
+    // middle character has no pair, but it is uppercased as well
+    if (job->length % 2 == 1) {
+        reverse_apply(job->level, job->out + half, 1, job->out + half);
+    }
+}
+
+static size_t run(struct thread_pool *pool,
+        const struct bmp_key *key,
+        bool decrypting,
+        size_t threshold,
+        const void *in,
+        size_t length,
+        void *out,
+        size_t out_cap)
+{
+    if (length != 0 && (in == NULL || out == NULL || out_cap < length)) {
+        return BMP_N_ERROR;
+    }
+    if (length < threshold || length == 0 || pool->count == 1) {
+        return decrypting ? bmp_key_decrypt(key, in, length, out, out_cap) : bmp_key_encrypt(key, in, length, out, out_cap);
+    }
+
+    struct job job = { key, simd_detect(), decrypting, in == out, in, out, length, 0, 0, { 0 } };
+
+    // chunks are aligned to the size of the vectors
+    job.chunk = (length + CHUNKS_PER_THREAD * pool->count - 1) / (CHUNKS_PER_THREAD * pool->count);
+    if (job.chunk < (length + MAX_CHUNKS - 1) / MAX_CHUNKS) {
+        job.chunk = (length + MAX_CHUNKS - 1) / MAX_CHUNKS;
+    }
+    job.chunk = job.chunk < MIN_CHUNK ? MIN_CHUNK : (job.chunk + 63) & ~(size_t) 63;
+    job.chunks = (length + job.chunk - 1) / job.chunk;
+
+    if (job.in_place && !decrypting) {
+        reverse_in_place(pool, &job);
+    }
+
+    thread_pool_run(pool, count_task, &job, job.chunks);
+
+    // counts of the letters are turned into the positions in the key
+    size_t offset = 0;
+    for (size_t i = 0; i < job.chunks; i++) {
+        size_t letters = job.offsets[i];
+        job.offsets[i] = offset;
+        offset = (offset + letters) % key->length;
+    }
+
+    thread_pool_run(pool, apply_task, &job, job.chunks);
+
+    if (job.in_place && decrypting) {
+        reverse_in_place(pool, &job);
+    }
+    return length;
+}
+
+size_t bmp_encrypt_parallel(struct thread_pool *pool,
+        const struct bmp_key *key,
+        size_t threshold,
+        const void *in,
+        size_t length,
+        void *out,
+        size_t out_cap)
+{
+    return run(pool, key, false, threshold, in, length, out, out_cap);
+}
+
+size_t bmp_decrypt_parallel(struct thread_pool *pool,
+        const struct bmp_key *key,
+        size_t threshold,
+        const void *in,
+        size_t length,
+        void *out,
+        size_t out_cap)
+{
+    return run(pool, key, true, threshold, in, length, out, out_cap);
+}
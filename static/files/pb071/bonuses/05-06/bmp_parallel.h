@@ -0,0 +1,55 @@
+#ifndef _BMP_PARALLEL_H
+#define _BMP_PARALLEL_H
+
+#include "bmp_key.h"
+#include "pool.h"
+
+#include <stddef.h>
+
+/**
+ * Default size of the input from which it pays off to split the work between
+ * the threads.
+ */
+#define BMP_PARALLEL_THRESHOLD ((size_t) 1 << 20)
+
+/**
+ * Encrypts the input by the BMP cipher on all threads of the pool, result is
+ * the same as the one of bmp_key_encrypt().
+ *
+ * Position in the key of each character depends on the count of the letters
+ * before it, so the letters are counted in each chunk of the input first (in
+ * parallel), then the chunks are encrypted directly into their final positions
+ * in the output.
+ *
+ * @param pool pool of the threads
+ * @param key compiled key
+ * @param threshold inputs shorter than this are encrypted only by the calling
+ * thread, see BMP_PARALLEL_THRESHOLD
+ * @param in input bytes
+ * @param length count of the input bytes
+ * @param out output buffer, can be the same as the input
+ * @param out_cap capacity of the output buffer
+ * @return count of the bytes written to the output, or BMP_N_ERROR if the
+ * output buffer is too small.
+ */
+size_t bmp_encrypt_parallel(struct thread_pool *pool,
+        const struct bmp_key *key,
+        size_t threshold,
+        const void *in,
+        size_t length,
+        void *out,
+        size_t out_cap);
+
+/**
+ * Decrypts the input by the BMP cipher on all threads of the pool, see
+ * bmp_encrypt_parallel().
+ */
+size_t bmp_decrypt_parallel(struct thread_pool *pool,
+        const struct bmp_key *key,
+        size_t threshold,
+        const void *in,
+        size_t length,
+        void *out,
+        size_t out_cap);
+
+#endif
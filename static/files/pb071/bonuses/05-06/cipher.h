@@ -0,0 +1,86 @@
+#ifndef _CIPHER_H
+#define _CIPHER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+ * Per-character steps of the BMP cipher shared by the optimized variants. Only
+ * ASCII letters are considered alphabetic, as in the "C" locale.
+ */
+
+#define ALPHABET_SIZE 26
+
+static inline bool is_letter(unsigned char c)
+{
+    return (unsigned char) ((c | 0x20) - 'a') < ALPHABET_SIZE;
+}
+
+static inline unsigned char to_upper(unsigned char c)
+{
+    return (unsigned char) (c - 'a') < ALPHABET_SIZE ? (unsigned char) (c - ('a' - 'A')) : c;
+}
+
+/**
+ * @brief Checks the key and computes its length.
+ * @param key Key of the Vigenère cipher.
+ * @param length Output variable where the length of the key is stored.
+ * @returns <code>true</code> if the key is non-empty word consisting only of
+ * alphabetical characters, <code>false</code> otherwise.
+ */
+static inline bool key_length(const char *key, size_t *length)
+{
+    if (key == NULL || *key == '\0') {
+        return false;
+    }
+
+    size_t i = 0;
+    for (; key[i] != '\0'; i++) {
+        if (!is_letter((unsigned char) key[i])) {
+            return false;
+        }
+    }
+
+    *length = i;
+    return true;
+}
+
+/**
+ * @brief Gets the shift of the letter of the key, 'A' and 'a' shift by 0.
+ */
+static inline unsigned key_shift(char letter)
+{
+    return (unsigned) (((unsigned char) letter | 0x20) - 'a');
+}
+
+/**
+ * @brief Shifts the uppercase letter forward by the given shift (0–25) within
+ * the alphabet.
+ */
+static inline unsigned char shift_letter(unsigned char c, unsigned shift)
+{
+    unsigned shifted = c + shift;
+    return (unsigned char) (shifted > 'Z' ? shifted - ALPHABET_SIZE : shifted);
+}
+
+/**
+ * @brief Swaps the bits within both pairs of the upper nibble.
+ */
+static inline unsigned swap_pairs(unsigned nibble)
+{
+    return ((nibble & 0xA) >> 1) | ((nibble & 0x5) << 1);
+}
+
+static inline unsigned char bit_encrypt_char(unsigned char c)
+{
+    unsigned high = swap_pairs(c >> 4);
+    return (unsigned char) ((high << 4) | ((c & 0xF) ^ high));
+}
+
+static inline unsigned char bit_decrypt_char(unsigned char c)
+{
+    unsigned high = c >> 4;
+    return (unsigned char) ((swap_pairs(high) << 4) | ((c & 0xF) ^ high));
+}
+
+#endif
@@ -0,0 +1,244 @@
+#include "bmp_key.h"
+#include "cipher.h"
+
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define DEFAULT_BLOCK_MEGABYTES 8
+#define MAX_BLOCK_MEGABYTES 1024
+
+/**
+ * @brief Parses the size of the block.
+ * @param text Size in MiB.
+ * @param block Output parameter for the size of the block in bytes.
+ * @returns <code>true</code> if the text is a number from 1 to <code>
+ * MAX_BLOCK_MEGABYTES</code>, <code>false</code> otherwise.
+ */
+static bool parse_block(const char *text, size_t *block)
+{
+    // strtoul would skip the whitespace and accept negative numbers
+    if (!isdigit((unsigned char) text[0])) {
+        return false;
+    }
+
+    char *end;
+    errno = 0;
+    unsigned long megabytes = strtoul(text, &end, 10);
+    if (errno != 0 || *end != '\0' || megabytes == 0 || megabytes > MAX_BLOCK_MEGABYTES) {
+        return false;
+    }
+
+    *block = (size_t) megabytes << 20;
+    return true;
+}
+
+/**
+ * @brief Writes the whole buffer at the given position of the file.
+ */
+static bool write_at(int fd, const unsigned char *buffer, size_t length, off_t position)
+{
+    while (length > 0) {
+        ssize_t written = pwrite(fd, buffer, length, position);
+        if (written < 0) {
+            return false;
+        }
+        buffer += written;
+        length -= (size_t) written;
+        position += written;
+    }
+    return true;
+}
+
+/**
+ * @brief Encrypts (or decrypts) the mapped input block by block; the output is
+ * written through one buffer of the size of the block, so the memory used does
+ * not depend on the size of the file.
+ *
+ * Encryption goes from the end of the input to honour the reversal, each block
+ * is written to the start of the output that has not been written yet.
+ * Decryption goes from the start of the input and writes from the end of the
+ * output.
+ */
+static bool process(const struct bmp_key *key, bool decrypting, const unsigned char *input, size_t length, int output, unsigned char *buffer, size_t block)
+{
+    const uintptr_t page = (uintptr_t) sysconf(_SC_PAGESIZE);
+
+    size_t offset = 0;
+    for (size_t done = 0; done < length; done += block) {
+        size_t size = length - done < block ? length - done : block;
+        const unsigned char *source = decrypting ? input + done : input + length - done - size;
+        off_t target = (off_t) (decrypting ? length - done - size : done);
+
+        // next block is read ahead while this one is processed
+        size_t next = length - done - size < block ? length - done - size : block;
+        if (next > 0) {
+            uintptr_t ahead = (uintptr_t) (decrypting ? source + size : source - next);
+            madvise((void *) (ahead & ~(page - 1)), next + (ahead & (page - 1)), MADV_WILLNEED);
+        }
+
+        offset = decrypting ? bmp_key_decrypt_part(key, offset, source, size, buffer) : bmp_key_encrypt_part(key, offset, source, size, buffer);
+        if (!write_at(output, buffer, size, target)) {
+            return false;
+        }
+
+        // pages of the processed block are not needed anymore, so that the
+        // mapping does not grow with the size of the file
+        uintptr_t first = ((uintptr_t) source + page - 1) & ~(page - 1);
+        uintptr_t last = ((uintptr_t) source + size) & ~(page - 1);
+        if (first < last) {
+            madvise((void *) first, last - first, MADV_DONTNEED);
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Creates the output file and fills it with the processed input.
+ * @returns Exit code of the program.
+ */
+static int write_output(const struct bmp_key *key, bool decrypting, size_t block, const unsigned char *input, const struct stat *input_info, const char *path)
+{
+    size_t length = (size_t) input_info->st_size;
+
+    // output is not truncated until it is known not to be the input, which
+    // is still being read from the mapping
+    struct stat info;
+    int output = open(path, O_WRONLY | O_CREAT, 0644);
+    if (output == -1 || fstat(output, &info) == -1) {
+        fprintf(stderr, "Could not create the output %s\n", path);
+        if (output != -1) {
+            close(output);
+        }
+        return 2;
+    }
+    if (info.st_dev == input_info->st_dev && info.st_ino == input_info->st_ino) {
+        fprintf(stderr, "Output %s is the same file as the input\n", path);
+        close(output);
+        return 2;
+    }
+
+    // output is preallocated, since the blocks are not written in order when
+    // decrypting
+    if (ftruncate(output, 0) == -1 || ftruncate(output, (off_t) length) == -1) {
+        fprintf(stderr, "Could not create the output %s\n", path);
+        close(output);
+        return 2;
+    }
+
+    int result = 0;
+    if (length > 0) {
+        block = length < block ? length : block;
+        unsigned char *buffer = malloc(block);
+        if (buffer == NULL || !process(key, decrypting, input, length, output, buffer, block)) {
+            result = 2;
+        }
+        free(buffer);
+    }
+
+    if (close(output) == -1) {
+        result = 2;
+    }
+    if (result != 0) {
+        fprintf(stderr, "Could not write the output %s\n", path);
+    }
+    return result;
+}
+
+/**
+ * @brief Maps the input file into the memory and processes it.
+ * @returns Exit code of the program.
+ */
+static int process_file(const struct bmp_key *key, bool decrypting, size_t block, const char *input_path, const char *output_path)
+{
+    struct stat info;
+    int input = open(input_path, O_RDONLY);
+    if (input == -1 || fstat(input, &info) == -1) {
+        fprintf(stderr, "Could not open the input %s\n", input_path);
+        if (input != -1) {
+            close(input);
+        }
+        return 2;
+    }
+
+    // empty file cannot be mapped
+    size_t length = (size_t) info.st_size;
+    unsigned char *mapping = NULL;
+    if (length > 0 && (mapping = mmap(NULL, length, PROT_READ, MAP_PRIVATE, input, 0)) == MAP_FAILED) {
+        fprintf(stderr, "Could not map the input %s\n", input_path);
+        close(input);
+        return 2;
+    }
+
+    int result = write_output(key, decrypting, block, mapping, &info, output_path);
+
+    if (mapping != NULL) {
+        munmap(mapping, length);
+    }
+    close(input);
+    return result;
+}
+
+/**
+ * @brief Main function of a program.
+ * @returns Exit code that denotes following:
+ *      0 in case of success
+ *      1 in case of invalid usage
+ *      2 in case of failure on the input or output file, or if the memory
+ *        could not be allocated
+ *      3 in case of invalid key
+ */
+int main(int argc, char **argv)
+{
+    bool decrypting = false;
+    size_t block = (size_t) DEFAULT_BLOCK_MEGABYTES << 20;
+    bool valid = true;
+
+    int option;
+    while ((option = getopt(argc, argv, "db:")) != -1) {
+        switch (option) {
+        case 'd':
+            decrypting = true;
+            break;
+        case 'b':
+            valid = valid && parse_block(optarg, &block);
+            break;
+        default:
+            valid = false;
+            break;
+        }
+    }
+
+    if (!valid || argc - optind != 3) {
+        printf("Usage: %s [-d] [-b MiB] <key> <input> <output>\n", argv[0]);
+        printf("  -d      decrypt the input instead of encrypting it\n");
+        printf("  -b MiB  size of the blocks the input is processed in, at most %d (default %d)\n", MAX_BLOCK_MEGABYTES, DEFAULT_BLOCK_MEGABYTES);
+        printf("Memory used does not depend on the size of the input.\n");
+        return 1;
+    }
+
+    // key is checked beforehand, so that the failure of the initialization
+    // means that its tables could not be allocated
+    size_t length;
+    if (!key_length(argv[optind], &length)) {
+        fprintf(stderr, "Invalid key %s\n", argv[optind]);
+        return 3;
+    }
+
+    struct bmp_key key;
+    if (!bmp_key_init(&key, argv[optind])) {
+        fprintf(stderr, "Could not allocate the key\n");
+        return 2;
+    }
+
+    int result = process_file(&key, decrypting, block, argv[optind + 1], argv[optind + 2]);
+    bmp_key_destroy(&key);
+    return result;
+}
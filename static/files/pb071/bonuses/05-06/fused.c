@@ -0,0 +1,62 @@
+#include "fused.h"
+
+#include "cipher.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+unsigned char *bmp_encrypt_fused(const char *key, const char *text)
+{
+    size_t length_of_key;
+    if (text == NULL || !key_length(key, &length_of_key)) {
+        return NULL;
+    }
+
+    size_t length = strlen(text);
+    unsigned char *encrypted = malloc(length + 1);
+    if (encrypted == NULL) {
+        return NULL;
+    }
+
+    // i-th character of the reversed string is the i-th one from the end
+    size_t k = 0;
+    for (size_t i = 0; i < length; i++) {
+        unsigned char c = to_upper((unsigned char) text[length - 1 - i]);
+        if (is_letter(c)) {
+            c = shift_letter(c, key_shift(key[k]));
+            k = (k + 1 == length_of_key) ? 0 : k + 1;
+        }
+        encrypted[i] = bit_encrypt_char(c);
+    }
+    encrypted[length] = '\0';
+
+    return encrypted;
+}
+
+char *bmp_decrypt_fused(const char *key, const unsigned char *text)
+{
+    size_t length_of_key;
+    if (text == NULL || !key_length(key, &length_of_key)) {
+        return NULL;
+    }
+
+    size_t length = strlen((const char *) text);
+    char *decrypted = malloc(length + 1);
+    if (decrypted == NULL) {
+        return NULL;
+    }
+
+    // key is applied in the order of the ciphertext, result is written backwards
+    size_t k = 0;
+    for (size_t i = 0; i < length; i++) {
+        unsigned char c = to_upper(bit_decrypt_char(text[i]));
+        if (is_letter(c)) {
+            c = shift_letter(c, ALPHABET_SIZE - key_shift(key[k]));
+            k = (k + 1 == length_of_key) ? 0 : k + 1;
+        }
+        decrypted[length - 1 - i] = (char) c;
+    }
+    decrypted[length] = '\0';
+
+    return decrypted;
+}
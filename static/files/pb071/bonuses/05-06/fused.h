@@ -0,0 +1,33 @@
+#ifndef _FUSED_H
+#define _FUSED_H
+
+/**
+ * Function for encrypting the given plaintext by the BMP cipher in a single
+ * pass. The result is the same as the one of bmp_encrypt(), but the input is
+ * read backwards and both the Vigenère cipher and the bitwise encryption are
+ * applied on each character right away, without any intermediate strings.
+ *
+ * @param key Pointer to a string representing the key which will be used
+ * for encrypting the plaintext. The key is represented by a single
+ * case-insensitive word consisting of only alphabetical characters.
+ * @param text String representing the plaintext to be encrypted.
+ * @return the address of a copy of the ciphertext encrypted by the BMP cipher,
+ * or NULL if the encryption was not successful.
+ */
+unsigned char *bmp_encrypt_fused(const char *key, const char *text);
+
+/**
+ * Function for decrypting the given ciphertext by the BMP cipher in a single
+ * pass, it is the inverse of bmp_encrypt_fused() and gives the same result as
+ * bmp_decrypt().
+ *
+ * @param key Pointer to a string representing the key which has been used
+ * for encrypting the ciphertext. The key is represented by a single
+ * case-insensitive word consisting of only alphabetical characters.
+ * @param text String representing the ciphertext to be decrypted.
+ * @return the address of a copy of the plaintext decrypted by the BMP cipher,
+ * or NULL if the decryption was not successful.
+ */
+char *bmp_decrypt_fused(const char *key, const unsigned char *text);
+
+#endif
@@ -1,4 +1,4 @@
-#include "playfair.h"
+#include "bmp.h"
 
 #include <stdio.h>
 
@@ -0,0 +1,115 @@
+#include "pool.h"
+
+#include <stdlib.h>
+#include <unistd.h>
+
+/**
+ * @brief Runs the tasks of the current job until there are none left.
+ */
+static void work(struct thread_pool *pool)
+{
+    size_t index;
+    while ((index = atomic_fetch_add(&pool->next, 1)) < pool->tasks) {
+        pool->task(pool->context, index);
+    }
+}
+
+static void *worker(void *argument)
+{
+    struct thread_pool *pool = argument;
+    size_t generation = 0;
+
+    pthread_mutex_lock(&pool->lock);
+    for (;;) {
+        while (!pool->stop && pool->generation == generation) {
+            pthread_cond_wait(&pool->wake, &pool->lock);
+        }
+        if (pool->stop) {
+            break;
+        }
+        generation = pool->generation;
+
+        pthread_mutex_unlock(&pool->lock);
+        work(pool);
+        pthread_mutex_lock(&pool->lock);
+
+        pool->idle++;
+        pthread_cond_signal(&pool->finished);
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    return NULL;
+}
+
+bool thread_pool_init(struct thread_pool *pool, size_t threads)
+{
+    if (threads == 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = online > 0 ? (size_t) online : 1;
+    }
+
+    pool->threads = malloc(threads * sizeof(pthread_t));
+    if (pool->threads == NULL) {
+        return false;
+    }
+    if (pthread_mutex_init(&pool->lock, NULL) != 0) {
+        free(pool->threads);
+        return false;
+    }
+    pthread_cond_init(&pool->wake, NULL);
+    pthread_cond_init(&pool->finished, NULL);
+
+    pool->task = NULL;
+    pool->context = NULL;
+    pool->tasks = 0;
+    atomic_init(&pool->next, 0);
+    pool->idle = 0;
+    pool->generation = 0;
+    pool->stop = false;
+
+    // calling thread is the first one of the pool
+    pool->count = 1;
+    while (pool->count < threads && pthread_create(&pool->threads[pool->count], NULL, worker, pool) == 0) {
+        pool->count++;
+    }
+    return true;
+}
+
+void thread_pool_run(struct thread_pool *pool, pool_task_t task, void *context, size_t count)
+{
+    pthread_mutex_lock(&pool->lock);
+    pool->task = task;
+    pool->context = context;
+    pool->tasks = count;
+    atomic_store(&pool->next, 0);
+    pool->idle = 0;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+
+    work(pool);
+
+    pthread_mutex_lock(&pool->lock);
+    while (pool->idle < pool->count - 1) {
+        pthread_cond_wait(&pool->finished, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
+
+void thread_pool_destroy(struct thread_pool *pool)
+{
+    pthread_mutex_lock(&pool->lock);
+    pool->stop = true;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (size_t i = 1; i < pool->count; i++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+
+    pthread_cond_destroy(&pool->finished);
+    pthread_cond_destroy(&pool->wake);
+    pthread_mutex_destroy(&pool->lock);
+    free(pool->threads);
+    pool->threads = NULL;
+}
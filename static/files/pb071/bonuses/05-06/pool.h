@@ -0,0 +1,66 @@
+#ifndef _POOL_H
+#define _POOL_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @brief Task that is run for each index of the job.
+ */
+typedef void (*pool_task_t)(void *context, size_t index);
+
+/**
+ * @brief Threads that are started once and then run any number of jobs; job
+ * consists of tasks with indices that are picked by the threads one by one.
+ */
+struct thread_pool
+{
+    pthread_t *threads;
+    /** Count of the threads including the one that runs the jobs. */
+    size_t count;
+
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    pthread_cond_t finished;
+
+    pool_task_t task;
+    void *context;
+    size_t tasks;
+    atomic_size_t next;
+    /** Count of the workers that have finished current job. */
+    size_t idle;
+    /** Incremented with each job, so that workers recognize a new one. */
+    size_t generation;
+    bool stop;
+};
+
+/**
+ * @brief Starts the threads of the pool.
+ * @param pool Pool to be initialized.
+ * @param threads Count of the threads including the calling one, 0 to use all
+ * online processors.
+ * @returns <code>true</code> if the pool has been initialized, <code>false
+ * </code> otherwise. In case some of the threads could not be started, the pool
+ * works with the rest of them.
+ */
+bool thread_pool_init(struct thread_pool *pool, size_t threads);
+
+/**
+ * @brief Runs the task for each index from 0 to <code>count - 1</code> and
+ * waits until all of them are finished. Calling thread takes part in the job.
+ * @param pool Pool of the threads.
+ * @param task Task to be run.
+ * @param context Context passed to the task.
+ * @param count Count of the tasks.
+ */
+void thread_pool_run(struct thread_pool *pool, pool_task_t task, void *context, size_t count);
+
+/**
+ * @brief Stops and joins the threads of the pool.
+ * @param pool Pool to be destroyed.
+ */
+void thread_pool_destroy(struct thread_pool *pool);
+
+#endif
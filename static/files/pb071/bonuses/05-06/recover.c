@@ -0,0 +1,168 @@
+#include "recover.h"
+
+#include "cipher.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/** Each column must have at least this many letters to be evaluated. */
+#define MIN_COLUMN 8
+
+/** Index of coincidence of a candidate must reach this part of the best one. */
+#define IOC_TOLERANCE 0.9
+
+/** Relative frequencies of the letters in English texts. */
+static const double english[ALPHABET_SIZE] = {
+    0.08167, 0.01492, 0.02782, 0.04253, 0.12702, 0.02228, 0.02015, 0.06094, 0.06966,
+    0.00153, 0.00772, 0.04025, 0.02406, 0.06749, 0.07507, 0.01929, 0.00095, 0.05987,
+    0.06327, 0.09056, 0.02758, 0.00978, 0.02360, 0.00150, 0.01974, 0.00074
+};
+
+/**
+ * @brief Letters of the ciphertext and the results of the evaluation.
+ */
+struct analysis
+{
+    /** Letters as indices within the alphabet. */
+    unsigned char *letters;
+    size_t count;
+
+    /** Index of coincidence for each candidate length (index 0 is length 1). */
+    double *coincidence;
+    /** Length of the key that is being recovered. */
+    size_t key_length;
+    char *key;
+};
+
+/**
+ * @brief Counts the letters in each column. Four copies of the histogram are
+ * used for consecutive rows, so that the increments of the same counter do not
+ * depend on each other.
+ */
+static void histogram(const struct analysis *analysis, size_t columns, size_t column, size_t counts[ALPHABET_SIZE])
+{
+    size_t partial[4][ALPHABET_SIZE] = { { 0 } };
+    const unsigned char *letters = analysis->letters;
+    size_t count = analysis->count;
+
+    size_t i = column;
+    for (; i + 3 * columns < count; i += 4 * columns) {
+        partial[0][letters[i]]++;
+        partial[1][letters[i + columns]]++;
+        partial[2][letters[i + 2 * columns]]++;
+        partial[3][letters[i + 3 * columns]]++;
+    }
+    for (; i < count; i += columns) {
+        partial[0][letters[i]]++;
+    }
+
+    for (size_t letter = 0; letter < ALPHABET_SIZE; letter++) {
+        counts[letter] = partial[0][letter] + partial[1][letter] + partial[2][letter] + partial[3][letter];
+    }
+}
+
+/**
+ * @brief Computes the average index of coincidence of the columns for the
+ * candidate length of the key.
+ */
+static void coincidence_task(void *context, size_t index)
+{
+    struct analysis *analysis = context;
+    size_t columns = index + 1;
+    double total = 0;
+
+    for (size_t column = 0; column < columns; column++) {
+        size_t counts[ALPHABET_SIZE];
+        histogram(analysis, columns, column, counts);
+
+        size_t letters = 0, pairs = 0;
+        for (size_t letter = 0; letter < ALPHABET_SIZE; letter++) {
+            letters += counts[letter];
+            pairs += counts[letter] * (counts[letter] - (counts[letter] > 0));
+        }
+        total += letters > 1 ? (double) pairs / (double) (letters * (letters - 1)) : 0;
+    }
+
+    analysis->coincidence[index] = total / (double) columns;
+}
+
+/**
+ * @brief Finds the letter of the key for the column by the chi-squared test.
+ */
+static void column_task(void *context, size_t column)
+{
+    struct analysis *analysis = context;
+    size_t counts[ALPHABET_SIZE];
+    histogram(analysis, analysis->key_length, column, counts);
+
+    size_t letters = 0;
+    for (size_t letter = 0; letter < ALPHABET_SIZE; letter++) {
+        letters += counts[letter];
+    }
+
+    size_t best = 0;
+    double best_score = 0;
+    for (size_t shift = 0; shift < ALPHABET_SIZE; shift++) {
+        double score = 0;
+        for (size_t letter = 0; letter < ALPHABET_SIZE; letter++) {
+            double expected = english[letter] * (double) letters;
+            double difference = (double) counts[(letter + shift) % ALPHABET_SIZE] - expected;
+            score += difference * difference / expected;
+        }
+
+        if (shift == 0 || score < best_score) {
+            best = shift;
+            best_score = score;
+        }
+    }
+
+    analysis->key[column] = (char) ('A' + best);
+}
+
+size_t vigenere_recover_key(struct thread_pool *pool, const void *ciphertext, size_t length, size_t max_key_length, char *key)
+{
+    const unsigned char *text = ciphertext;
+    key[0] = '\0';
+    if (length == 0) {
+        return 0;
+    }
+
+    struct analysis analysis = { malloc(length), 0, NULL, 0, key };
+    if (analysis.letters == NULL) {
+        return 0;
+    }
+
+    for (size_t i = 0; i < length; i++) {
+        unsigned char c = to_upper(text[i]);
+        if (is_letter(c)) {
+            analysis.letters[analysis.count++] = (unsigned char) (c - 'A');
+        }
+    }
+
+    // every column must have enough letters to be evaluated
+    if (max_key_length > analysis.count / MIN_COLUMN) {
+        max_key_length = analysis.count / MIN_COLUMN;
+    }
+    if (max_key_length == 0 || (analysis.coincidence = malloc(max_key_length * sizeof(double))) == NULL) {
+        free(analysis.letters);
+        return 0;
+    }
+
+    thread_pool_run(pool, coincidence_task, &analysis, max_key_length);
+
+    double best = 0;
+    for (size_t i = 0; i < max_key_length; i++) {
+        best = analysis.coincidence[i] > best ? analysis.coincidence[i] : best;
+    }
+    analysis.key_length = 1;
+    while (analysis.coincidence[analysis.key_length - 1] < IOC_TOLERANCE * best) {
+        analysis.key_length++;
+    }
+
+    thread_pool_run(pool, column_task, &analysis, analysis.key_length);
+    key[analysis.key_length] = '\0';
+
+    free(analysis.coincidence);
+    free(analysis.letters);
+    return analysis.key_length;
+}
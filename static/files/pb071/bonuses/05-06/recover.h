@@ -0,0 +1,36 @@
+#ifndef _RECOVER_H
+#define _RECOVER_H
+
+#include "pool.h"
+
+#include <stddef.h>
+
+/**
+ * Longest key that is considered by default.
+ */
+#define RECOVER_MAX_KEY 32
+
+/**
+ * @brief Recovers the key of the Vigenère cipher from the ciphertext of an
+ * English text.
+ *
+ * Only the letters of the ciphertext are considered, since the key advances
+ * only on them. Length of the key is estimated by the index of coincidence of
+ * the columns (letters that share the letter of the key) for each candidate
+ * length, the shortest length whose index is close to the best one is picked,
+ * so that multiples of the key are not preferred. Each column is then shifted
+ * to fit the frequencies of the English letters best (chi-squared test).
+ * Candidate lengths and the columns are evaluated in parallel.
+ *
+ * @param pool Pool of the threads.
+ * @param ciphertext Ciphertext produced by vigenere_encrypt().
+ * @param length Length of the ciphertext.
+ * @param max_key_length Longest key that is considered.
+ * @param key Output buffer for the key of <code>max_key_length + 1</code>
+ * characters, key is terminated by zero.
+ * @returns Length of the recovered key, or 0 (with an empty key) if there are
+ * not enough letters in the ciphertext or the memory could not be allocated.
+ */
+size_t vigenere_recover_key(struct thread_pool *pool, const void *ciphertext, size_t length, size_t max_key_length, char *key);
+
+#endif
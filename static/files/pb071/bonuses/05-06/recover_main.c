@@ -0,0 +1,94 @@
+#include "bit_simd.h"
+#include "pool.h"
+#include "recover.h"
+#include "simd.h"
+
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * @brief Main function of a program.
+ * @returns Exit code that denotes following:
+ *      0 in case the key has been recovered
+ *      1 in case of invalid usage
+ *      2 in case of failure on the ciphertext file
+ *      3 in case there are not enough letters in the ciphertext
+ */
+int main(int argc, char **argv)
+{
+    bool bmp = false;
+    size_t max_key_length = RECOVER_MAX_KEY;
+    bool valid = true;
+
+    int option;
+    while ((option = getopt(argc, argv, "bm:")) != -1) {
+        switch (option) {
+        case 'b':
+            bmp = true;
+            break;
+        case 'm':
+            max_key_length = strtoul(optarg, NULL, 10);
+            valid = valid && max_key_length > 0;
+            break;
+        default:
+            valid = false;
+            break;
+        }
+    }
+
+    if (!valid || argc - optind != 1) {
+        printf("Usage: %s [-b] [-m max-key-length] <ciphertext>\n", argv[0]);
+        printf("  -b  ciphertext has been produced by bmp_encrypt() instead of vigenere_encrypt()\n");
+        printf("  -m  longest key that is considered (default %d)\n", RECOVER_MAX_KEY);
+        return 1;
+    }
+
+    struct stat info;
+    int input = open(argv[optind], O_RDONLY);
+    if (input == -1 || fstat(input, &info) == -1 || info.st_size == 0) {
+        fprintf(stderr, "Could not open the ciphertext %s\n", argv[optind]);
+        if (input != -1) {
+            close(input);
+        }
+        return 2;
+    }
+
+    // private mapping allows the bitwise decryption in place
+    size_t length = (size_t) info.st_size;
+    unsigned char *text = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE, input, 0);
+    close(input);
+    char *key = malloc(max_key_length + 1);
+    struct thread_pool pool;
+    if (text == MAP_FAILED || key == NULL || !thread_pool_init(&pool, 0)) {
+        fprintf(stderr, "Could not load the ciphertext %s\n", argv[optind]);
+        if (text != MAP_FAILED) {
+            munmap(text, length);
+        }
+        free(key);
+        return 2;
+    }
+
+    // reversal of the BMP cipher does not matter, key is applied in the order
+    // of the ciphertext
+    if (bmp) {
+        bit_apply(SIMD_AVX2, true, text, length, text);
+    }
+
+    int result = 0;
+    if (vigenere_recover_key(&pool, text, length, max_key_length, key) == 0) {
+        fprintf(stderr, "Not enough letters in the ciphertext\n");
+        result = 3;
+    } else {
+        printf("%s\n", key);
+    }
+
+    thread_pool_destroy(&pool);
+    free(key);
+    munmap(text, length);
+    return result;
+}
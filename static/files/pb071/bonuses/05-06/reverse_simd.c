@@ -0,0 +1,90 @@
+#include "reverse_simd.h"
+
+#include "cipher.h"
+
+#ifdef HAVE_SIMD_KERNELS
+#include <immintrin.h>
+#endif
+
+/**
+ * @brief Reverses the part of the block between the given positions, both ends
+ * are read before anything is written.
+ */
+static void reverse_scalar(const unsigned char *in, size_t front, size_t back, unsigned char *out)
+{
+    for (; back - front >= 2; front++, back--) {
+        unsigned char first = in[front];
+        unsigned char last = in[back - 1];
+        out[front] = to_upper(last);
+        out[back - 1] = to_upper(first);
+    }
+    if (back - front == 1) {
+        out[front] = to_upper(in[front]);
+    }
+}
+
+#ifdef HAVE_SIMD_KERNELS
+
+__attribute__((target("ssse3"))) static __m128i reverse_upper_ssse3(__m128i c)
+{
+    __m128i lower = _mm_sub_epi8(c, _mm_set1_epi8('a'));
+    lower = _mm_cmpeq_epi8(_mm_min_epu8(lower, _mm_set1_epi8(ALPHABET_SIZE - 1)), lower);
+    c = _mm_sub_epi8(c, _mm_and_si128(lower, _mm_set1_epi8(0x20)));
+    return _mm_shuffle_epi8(c, _mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0));
+}
+
+__attribute__((target("ssse3"))) static void reverse_ssse3(const unsigned char *in, size_t length, unsigned char *out)
+{
+    size_t front = 0, back = length;
+    for (; back - front >= 32; front += 16, back -= 16) {
+        __m128i first = _mm_loadu_si128((const __m128i *) (in + front));
+        __m128i last = _mm_loadu_si128((const __m128i *) (in + back - 16));
+        _mm_storeu_si128((__m128i *) (out + front), reverse_upper_ssse3(last));
+        _mm_storeu_si128((__m128i *) (out + back - 16), reverse_upper_ssse3(first));
+    }
+    reverse_scalar(in, front, back, out);
+}
+
+__attribute__((target("avx2"))) static __m256i reverse_upper_avx2(__m256i c)
+{
+    __m256i lower = _mm256_sub_epi8(c, _mm256_set1_epi8('a'));
+    lower = _mm256_cmpeq_epi8(_mm256_min_epu8(lower, _mm256_set1_epi8(ALPHABET_SIZE - 1)), lower);
+    c = _mm256_sub_epi8(c, _mm256_and_si256(lower, _mm256_set1_epi8(0x20)));
+
+    // bytes are reversed within the lanes, then the lanes are swapped
+    c = _mm256_shuffle_epi8(c, _mm256_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0));
+    return _mm256_permute4x64_epi64(c, 0x4E);
+}
+
+__attribute__((target("avx2"))) static void reverse_avx2(const unsigned char *in, size_t length, unsigned char *out)
+{
+    size_t front = 0, back = length;
+    for (; back - front >= 64; front += 32, back -= 32) {
+        __m256i first = _mm256_loadu_si256((const __m256i *) (in + front));
+        __m256i last = _mm256_loadu_si256((const __m256i *) (in + back - 32));
+        _mm256_storeu_si256((__m256i *) (out + front), reverse_upper_avx2(last));
+        _mm256_storeu_si256((__m256i *) (out + back - 32), reverse_upper_avx2(first));
+    }
+    reverse_scalar(in, front, back, out);
+}
+
+#endif
+
+void reverse_apply(enum simd_level_t level, const unsigned char *in, size_t length, unsigned char *out)
+{
+#ifdef HAVE_SIMD_KERNELS
+    switch (simd_supported(level)) {
+    case SIMD_AVX2:
+        reverse_avx2(in, length, out);
+        return;
+    case SIMD_SSSE3:
+        reverse_ssse3(in, length, out);
+        return;
+    default:
+        break;
+    }
+#else
+    (void) level;
+#endif
+    reverse_scalar(in, 0, length, out);
+}
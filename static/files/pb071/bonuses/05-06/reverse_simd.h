@@ -0,0 +1,23 @@
+#ifndef _REVERSE_SIMD_H
+#define _REVERSE_SIMD_H
+
+#include "simd.h"
+
+#include <stddef.h>
+
+/**
+ * @brief Copies the block of the text in reversed order and uppercases it.
+ *
+ * Vectors are taken from both ends of the block at once and swapped, so the
+ * output can be the same as the input.
+ *
+ * @param level Instruction set to be used, it is limited to the ones supported
+ * by the CPU.
+ * @param in Block of the text.
+ * @param length Length of the block.
+ * @param out Output buffer of <code>length</code> characters, either the same as
+ * the input or not overlapping with it at all.
+ */
+void reverse_apply(enum simd_level_t level, const unsigned char *in, size_t length, unsigned char *out);
+
+#endif
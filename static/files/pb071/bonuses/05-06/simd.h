@@ -0,0 +1,52 @@
+#ifndef _SIMD_H
+#define _SIMD_H
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HAVE_SIMD_KERNELS
+#endif
+
+/**
+ * Instruction sets the kernels are vectorized for, ordered from the weakest.
+ */
+enum simd_level_t
+{
+    SIMD_SCALAR,
+    /** 16 bytes at once, byte shuffles (pshufb) need SSSE3 on top of SSE2,
+     * letters are counted by POPCNT. */
+    SIMD_SSSE3,
+    /** 32 bytes at once, also with POPCNT. */
+    SIMD_AVX2,
+};
+
+#define SIMD_LEVELS 3
+
+/**
+ * @brief Detects the best instruction set supported by the CPU.
+ */
+static inline enum simd_level_t simd_detect(void)
+{
+#ifdef HAVE_SIMD_KERNELS
+    // some CPUs with SSSE3 (e.g. Core 2) do not have POPCNT
+    if (!__builtin_cpu_supports("popcnt")) {
+        return SIMD_SCALAR;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return SIMD_AVX2;
+    }
+    if (__builtin_cpu_supports("ssse3")) {
+        return SIMD_SSSE3;
+    }
+#endif
+    return SIMD_SCALAR;
+}
+
+/**
+ * @brief Limits the requested instruction set to the ones supported by the CPU.
+ */
+static inline enum simd_level_t simd_supported(enum simd_level_t level)
+{
+    enum simd_level_t best = simd_detect();
+    return level < best ? level : best;
+}
+
+#endif
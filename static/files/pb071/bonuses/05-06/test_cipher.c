@@ -0,0 +1,504 @@
+#include "bit_simd.h"
+#include "bmp.h"
+#include "bmp_key.h"
+#include "bmp_n.h"
+#include "bmp_parallel.h"
+#include "fused.h"
+#include "recover.h"
+#include "reverse_simd.h"
+#include "simd.h"
+#include "vigenere_simd.h"
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CUT_MAIN
+#include "cut.h"
+
+void test_bmp_fused(const char *key, const char *input)
+{
+    unsigned char *staged = bmp_encrypt(key, input);
+    unsigned char *encrypted = bmp_encrypt_fused(key, input);
+
+    ASSERT(staged != NULL);
+    ASSERT(encrypted != NULL);
+    ASSERT(strcmp((const char *) encrypted, (const char *) staged) == 0);
+
+    char *staged_decrypted = bmp_decrypt(key, encrypted);
+    char *decrypted = bmp_decrypt_fused(key, encrypted);
+
+    ASSERT(staged_decrypted != NULL);
+    ASSERT(decrypted != NULL);
+    ASSERT(strcmp(decrypted, staged_decrypted) == 0);
+
+    free(staged_decrypted);
+    free(decrypted);
+    free(encrypted);
+    free(staged);
+}
+
+TEST(BMP_FUSED)
+{
+    SUBTEST(HELLO)
+    {
+        const unsigned char encrypted_expected[] = { 0xae, 0xae, 0xab, 0x85, 0x85 };
+        unsigned char *encrypted = bmp_encrypt_fused("fi", "hello");
+        char *decrypted = bmp_decrypt_fused("fi", encrypted);
+
+        ASSERT(memcmp(encrypted, encrypted_expected, 5) == 0 && encrypted[5] == '\0');
+        ASSERT(strcmp(decrypted, "HELLO") == 0);
+
+        free(decrypted);
+        free(encrypted);
+    }
+    SUBTEST(SAME_AS_STAGED)
+    {
+        test_bmp_fused("fi", "hello");
+        test_bmp_fused("asjdljasdja", "works");
+        test_bmp_fused("meh", "longerTextThatHasNoSpaces");
+        test_bmp_fused("CoMPuTeR", "Hello world! 1273912739&^%$$*((");
+        test_bmp_fused("zZ", "Zebra [at] the `zoo` {maybe}?");
+        test_bmp_fused("key", "");
+    }
+    SUBTEST(INVALID)
+    {
+        ASSERT(bmp_encrypt_fused(NULL, "text") == NULL);
+        ASSERT(bmp_encrypt_fused("", "text") == NULL);
+        ASSERT(bmp_encrypt_fused("k3y", "text") == NULL);
+        ASSERT(bmp_encrypt_fused("key", NULL) == NULL);
+        ASSERT(bmp_decrypt_fused("k y", (const unsigned char *) "text") == NULL);
+        ASSERT(bmp_decrypt_fused("key", NULL) == NULL);
+    }
+}
+
+void test_vigenere_simd(const char *key, const char *input, size_t offset)
+{
+    size_t length = strlen(input);
+    char *expected = vigenere_encrypt(key, input);
+    ASSERT(expected != NULL);
+
+    size_t length_of_key;
+    unsigned char *encrypt_table = vigenere_table(key, false, &length_of_key);
+    unsigned char *decrypt_table = vigenere_table(key, true, &length_of_key);
+    unsigned char *encrypted = malloc(length + 1);
+    ASSERT(encrypt_table != NULL && decrypt_table != NULL && encrypted != NULL);
+
+    for (int level = SIMD_SCALAR; level < SIMD_LEVELS; level++) {
+        // text is split into two blocks, key position carries over
+        size_t next = vigenere_apply(level, encrypt_table, length_of_key, 0, (const unsigned char *) input, offset, encrypted);
+        vigenere_apply(level, encrypt_table, length_of_key, next, (const unsigned char *) input + offset, length - offset, encrypted + offset);
+        ASSERT(memcmp(encrypted, expected, length) == 0);
+
+        // decrypted in place
+        vigenere_apply(level, decrypt_table, length_of_key, 0, encrypted, length, encrypted);
+        for (size_t i = 0; i < length; i++) {
+            ASSERT(encrypted[i] == toupper((unsigned char) input[i]));
+        }
+    }
+
+    free(encrypted);
+    free(decrypt_table);
+    free(encrypt_table);
+    free(expected);
+}
+
+TEST(VIGENERE_SIMD)
+{
+    SUBTEST(HELLO_WORLD)
+    {
+        char *encrypted = vigenere_encrypt_simd("CoMPuTeR", "Hello world!");
+        char *decrypted = vigenere_decrypt_simd("CoMPuTeR", encrypted);
+
+        ASSERT(strcmp(encrypted, "JSXAI PSINR!") == 0);
+        ASSERT(strcmp(decrypted, "HELLO WORLD!") == 0);
+
+        free(decrypted);
+        free(encrypted);
+    }
+    SUBTEST(SAME_AS_SCALAR)
+    {
+        const char *text = "The quick brown fox jumps over the lazy dog! 1273912739&^%$$*(( "
+                           "abcdefghijklmnopqrstuvwxyz@[`{ ABCDEFGHIJKLMNOPQRSTUVWXYZ\x7f\x80\xff "
+                           "zzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzz..................";
+
+        test_vigenere_simd("fi", text, 0);
+        test_vigenere_simd("CoMPuTeR", text, 7);
+        test_vigenere_simd("z", text, 33);
+        test_vigenere_simd("abcdefghijklmnopqrstuvwxyzabcdefghijklmnopqrstuvwxyz", text, 100);
+    }
+    SUBTEST(INVALID)
+    {
+        ASSERT(vigenere_encrypt_simd("", "text") == NULL);
+        ASSERT(vigenere_encrypt_simd("k3y", "text") == NULL);
+        ASSERT(vigenere_decrypt_simd("key", NULL) == NULL);
+    }
+}
+
+TEST(BIT_SIMD)
+{
+    SUBTEST(TABLES)
+    {
+        // zero byte cannot be passed in the string, it is its own image
+        char all[256];
+        for (size_t i = 0; i < 255; i++) {
+            all[i] = (char) (i + 1);
+        }
+        all[255] = '\0';
+
+        unsigned char *encrypted = bit_encrypt(all);
+        ASSERT(encrypted != NULL);
+        ASSERT(bit_encrypt_table[0] == 0 && bit_decrypt_table[0] == 0);
+        for (size_t i = 0; i < 255; i++) {
+            ASSERT(bit_encrypt_table[i + 1] == encrypted[i]);
+            ASSERT(bit_decrypt_table[encrypted[i]] == i + 1);
+        }
+        free(encrypted);
+    }
+    SUBTEST(KERNELS)
+    {
+        unsigned char input[256 * 3 + 5];
+        unsigned char output[sizeof(input)];
+        for (size_t i = 0; i < sizeof(input); i++) {
+            input[i] = (unsigned char) (i * 7);
+        }
+
+        for (int level = SIMD_SCALAR; level < SIMD_LEVELS; level++) {
+            bit_apply(level, false, input, sizeof(input), output);
+            for (size_t i = 0; i < sizeof(input); i++) {
+                ASSERT(output[i] == bit_encrypt_table[input[i]]);
+            }
+
+            bit_apply(level, true, output, sizeof(output), output);
+            ASSERT(memcmp(output, input, sizeof(input)) == 0);
+        }
+    }
+    SUBTEST(HELLO_WORLD)
+    {
+        const unsigned char output[] = { 0x80, 0x9c, 0x95, 0x95, 0x96, 0x11, 0xbc, 0x96, 0xb9, 0x95, 0x9d, 0x10, 0x00 };
+        unsigned char *encrypted = bit_encrypt_simd("Hello world!");
+        char *decrypted = bit_decrypt_simd(encrypted);
+
+        ASSERT(memcmp(encrypted, output, sizeof(output)) == 0);
+        ASSERT(strcmp(decrypted, "Hello world!") == 0);
+        ASSERT(bit_encrypt_simd(NULL) == NULL);
+
+        free(decrypted);
+        free(encrypted);
+    }
+}
+
+void test_bmp_n(const char *key, const char *input)
+{
+    size_t length = strlen(input);
+    unsigned char *expected = bmp_encrypt(key, input);
+    char *expected_decrypted = bmp_decrypt(key, expected);
+    char *reversed = reverse(input);
+    unsigned char *buffer = malloc(length + 1);
+    unsigned char *other = malloc(length + 1);
+    ASSERT(expected != NULL && expected_decrypted != NULL && reversed != NULL && buffer != NULL && other != NULL);
+
+    ASSERT(reverse_n(input, length, buffer, length) == length);
+    ASSERT(memcmp(buffer, reversed, length) == 0);
+
+    // separate buffers
+    ASSERT(bmp_encrypt_n(key, input, length, buffer, length + 1) == length);
+    ASSERT(memcmp(buffer, expected, length) == 0);
+    ASSERT(bmp_decrypt_n(key, buffer, length, other, length) == length);
+    ASSERT(memcmp(other, expected_decrypted, length) == 0);
+
+    // in place
+    memcpy(buffer, input, length);
+    ASSERT(bmp_encrypt_n(key, buffer, length, buffer, length) == length);
+    ASSERT(memcmp(buffer, expected, length) == 0);
+    ASSERT(bmp_decrypt_n(key, buffer, length, buffer, length) == length);
+    ASSERT(memcmp(buffer, expected_decrypted, length) == 0);
+
+    free(other);
+    free(buffer);
+    free(reversed);
+    free(expected_decrypted);
+    free(expected);
+}
+
+TEST(BMP_N)
+{
+    SUBTEST(SAME_AS_BMP)
+    {
+        test_bmp_n("fi", "hello");
+        test_bmp_n("meh", "longerTextThatHasNoSpaces");
+        test_bmp_n("CoMPuTeR", "Hello world! 1273912739&^%$$*((");
+        test_bmp_n("key", "");
+    }
+    SUBTEST(LONG)
+    {
+        // spans multiple blocks and both ends of the vectorized kernels
+        size_t length = 3 * 4096 + 77;
+        char *input = malloc(length + 1);
+        ASSERT(input != NULL);
+        for (size_t i = 0; i < length; i++) {
+            input[i] = " abcdefghijklmnopqrstuvwxyz,ABCDEFGHIJKLMNOPQRSTUVWXYZ!"[(i * 31 + i / 7) % 56];
+        }
+        input[length] = '\0';
+
+        test_bmp_n("fi", input);
+        test_bmp_n("LongerKeyThatDoesNotDivideTheBlock", input);
+        free(input);
+    }
+    SUBTEST(REVERSE_KERNELS)
+    {
+        const char *input = "The quick brown fox jumps over the lazy dog! 1273912739&^%$$*(( abcxyz";
+        size_t length = strlen(input);
+        char *expected = reverse(input);
+        unsigned char buffer[128];
+
+        for (int level = SIMD_SCALAR; level < SIMD_LEVELS; level++) {
+            for (size_t prefix = 0; prefix <= length; prefix += 7) {
+                char *reversed = reverse(input + length - prefix);
+                memcpy(buffer, input + length - prefix, prefix);
+                reverse_apply(level, buffer, prefix, buffer);
+                ASSERT(memcmp(buffer, reversed, prefix) == 0);
+                free(reversed);
+            }
+            reverse_apply(level, (const unsigned char *) input, length, buffer);
+            ASSERT(memcmp(buffer, expected, length) == 0);
+        }
+        free(expected);
+    }
+    SUBTEST(PARTS)
+    {
+        unsigned char buffer[16];
+        char text[16];
+
+        ASSERT(vigenere_encrypt_n("CoMPuTeR", "Hello world!", 12, text, sizeof(text)) == 12);
+        ASSERT(memcmp(text, "JSXAI PSINR!", 12) == 0);
+        ASSERT(vigenere_decrypt_n("CoMPuTeR", text, 12, text, sizeof(text)) == 12);
+        ASSERT(memcmp(text, "HELLO WORLD!", 12) == 0);
+
+        const unsigned char output[] = { 0x91, 0x9c, 0x95, 0x95, 0x96 };
+        ASSERT(bit_encrypt_n("hello", 5, buffer, sizeof(buffer)) == 5);
+        ASSERT(memcmp(buffer, output, 5) == 0);
+        ASSERT(bit_decrypt_n(buffer, 5, buffer, sizeof(buffer)) == 5);
+        ASSERT(memcmp(buffer, "hello", 5) == 0);
+    }
+    SUBTEST(ZERO_BYTES)
+    {
+        const char input[] = { 'a', '\0', 'b', '\0' };
+        unsigned char encrypted[4];
+        char decrypted[4];
+
+        ASSERT(bmp_encrypt_n("key", input, 4, encrypted, 4) == 4);
+        ASSERT(encrypted[0] == 0 && encrypted[2] == 0);
+        ASSERT(bmp_decrypt_n("key", encrypted, 4, decrypted, 4) == 4);
+        ASSERT(memcmp(decrypted, "A\0B", 4) == 0);
+    }
+    SUBTEST(INVALID)
+    {
+        char buffer[8];
+        ASSERT(reverse_n("hello", 5, buffer, 4) == BMP_N_ERROR);
+        ASSERT(bit_encrypt_n(NULL, 5, buffer, sizeof(buffer)) == BMP_N_ERROR);
+        ASSERT(vigenere_encrypt_n("k3y", "hello", 5, buffer, sizeof(buffer)) == BMP_N_ERROR);
+        ASSERT(bmp_encrypt_n("", "hello", 5, buffer, sizeof(buffer)) == BMP_N_ERROR);
+        ASSERT(bmp_decrypt_n("key", "hello", 5, NULL, 0) == BMP_N_ERROR);
+        ASSERT(bmp_encrypt_n("key", NULL, 0, NULL, 0) == 0);
+    }
+}
+
+TEST(BMP_KEY)
+{
+    SUBTEST(INVALID)
+    {
+        struct bmp_key key;
+        ASSERT(!bmp_key_init(&key, NULL));
+        ASSERT(!bmp_key_init(&key, ""));
+        ASSERT(!bmp_key_init(&key, "two words"));
+    }
+    SUBTEST(MESSAGES)
+    {
+        struct bmp_key key;
+        ASSERT(bmp_key_init(&key, "FaIlS"));
+
+        unsigned char encrypted[16];
+        char decrypted[16];
+        char *expected = vigenere_encrypt("fails", "realloc");
+
+        ASSERT(bmp_key_vigenere_encrypt(&key, "realloc", 7, decrypted, sizeof(decrypted)) == 7);
+        ASSERT(memcmp(decrypted, expected, 7) == 0);
+        ASSERT(bmp_key_vigenere_decrypt(&key, decrypted, 7, decrypted, sizeof(decrypted)) == 7);
+        ASSERT(memcmp(decrypted, "REALLOC", 7) == 0);
+        free(expected);
+
+        unsigned char *bmp_expected = bmp_encrypt("fails", "realloc");
+        ASSERT(bmp_key_encrypt(&key, "realloc", 7, encrypted, sizeof(encrypted)) == 7);
+        ASSERT(memcmp(encrypted, bmp_expected, 7) == 0);
+        ASSERT(bmp_key_decrypt(&key, encrypted, 7, decrypted, sizeof(decrypted)) == 7);
+        ASSERT(memcmp(decrypted, "REALLOC", 7) == 0);
+        ASSERT(bmp_key_encrypt(&key, "realloc", 7, encrypted, 6) == BMP_N_ERROR);
+        free(bmp_expected);
+
+        bmp_key_destroy(&key);
+    }
+    SUBTEST(BATCH)
+    {
+        const char *texts[] = { "hello", "", "Hello world!", "longerTextThatHasNoSpaces", "too long" };
+        unsigned char buffers[5][32];
+        struct bmp_message messages[5];
+
+        struct bmp_key key;
+        ASSERT(bmp_key_init(&key, "meh"));
+
+        for (size_t i = 0; i < 5; i++) {
+            messages[i] = (struct bmp_message) { texts[i], strlen(texts[i]), buffers[i], i == 4 ? 3 : 32, 0 };
+        }
+        ASSERT(bmp_encrypt_batch(&key, messages, 5) == 4);
+        ASSERT(messages[4].written == BMP_N_ERROR);
+
+        for (size_t i = 0; i < 4; i++) {
+            unsigned char *expected = bmp_encrypt("meh", texts[i]);
+            ASSERT(messages[i].written == strlen(texts[i]));
+            ASSERT(memcmp(buffers[i], expected, messages[i].written) == 0);
+            free(expected);
+
+            // decrypted in place
+            messages[i] = (struct bmp_message) { buffers[i], messages[i].written, buffers[i], 32, 0 };
+        }
+        ASSERT(bmp_decrypt_batch(&key, messages, 4) == 4);
+
+        for (size_t i = 0; i < 4; i++) {
+            char *expected = reverse(texts[i]);
+            char *twice = reverse(expected);
+            ASSERT(memcmp(buffers[i], twice, messages[i].written) == 0);
+            free(twice);
+            free(expected);
+        }
+
+        bmp_key_destroy(&key);
+    }
+}
+
+void test_bmp_parallel(struct thread_pool *pool, const char *word, size_t length)
+{
+    char *text = malloc(length);
+    unsigned char *expected = malloc(length);
+    unsigned char *buffer = malloc(length);
+    unsigned char *other = malloc(length);
+    ASSERT(text != NULL && expected != NULL && buffer != NULL && other != NULL);
+
+    for (size_t i = 0; i < length; i++) {
+        text[i] = " abcdefghijklmnopqrstuvwxyz,ABCDEFGHIJKLMNOPQRSTUVWXYZ!"[(i * 31 + i / 7) % 56];
+    }
+
+    struct bmp_key key;
+    ASSERT(bmp_key_init(&key, word));
+    ASSERT(bmp_key_encrypt(&key, text, length, expected, length) == length);
+
+    // separate buffers
+    ASSERT(bmp_encrypt_parallel(pool, &key, 0, text, length, buffer, length) == length);
+    ASSERT(memcmp(buffer, expected, length) == 0);
+    ASSERT(bmp_decrypt_parallel(pool, &key, 0, buffer, length, other, length) == length);
+    ASSERT(bmp_key_decrypt(&key, expected, length, buffer, length) == length);
+    ASSERT(memcmp(other, buffer, length) == 0);
+
+    // in place
+    memcpy(buffer, text, length);
+    ASSERT(bmp_encrypt_parallel(pool, &key, 0, buffer, length, buffer, length) == length);
+    ASSERT(memcmp(buffer, expected, length) == 0);
+    ASSERT(bmp_decrypt_parallel(pool, &key, 0, buffer, length, buffer, length) == length);
+    ASSERT(memcmp(buffer, other, length) == 0);
+
+    bmp_key_destroy(&key);
+    free(other);
+    free(buffer);
+    free(expected);
+    free(text);
+}
+
+TEST(BMP_PARALLEL)
+{
+    SUBTEST(SAME_AS_SERIAL)
+    {
+        struct thread_pool pool;
+        ASSERT(thread_pool_init(&pool, 4));
+
+        test_bmp_parallel(&pool, "fi", 1 << 20);
+        test_bmp_parallel(&pool, "CoMPuTeR", 5 * 65536 + 33);
+        test_bmp_parallel(&pool, "LongerKeyThatDoesNotDivideTheChunks", 3 * 65536 + 4097);
+        test_bmp_parallel(&pool, "short", 1000);
+
+        thread_pool_destroy(&pool);
+    }
+    SUBTEST(INVALID)
+    {
+        struct thread_pool pool;
+        struct bmp_key key;
+        char buffer[8];
+        ASSERT(thread_pool_init(&pool, 2));
+        ASSERT(bmp_key_init(&key, "key"));
+
+        ASSERT(bmp_encrypt_parallel(&pool, &key, 0, "hello", 5, buffer, 4) == BMP_N_ERROR);
+        ASSERT(bmp_decrypt_parallel(&pool, &key, 0, NULL, 5, buffer, 8) == BMP_N_ERROR);
+
+        bmp_key_destroy(&key);
+        thread_pool_destroy(&pool);
+    }
+}
+
+static const char *english_text
+        = "It was late in the evening when the last train finally left the station, and the small town "
+          "fell silent once again. The people who had come to see their friends off walked slowly back "
+          "to their houses, talking about the weather, the harvest and the new school that was being built "
+          "near the river. Nobody noticed the old man sitting on the bench under the lamp. He had been "
+          "waiting there since the morning, holding a letter that he had never opened. When the station "
+          "master came out to lock the doors, he asked the man whether he needed any help. The man smiled "
+          "and said that he was only waiting for his daughter, who had promised to come home for the summer. "
+          "The station master knew that there would be no other train until the next day, but he did not "
+          "have the heart to tell him. Instead he brought him a cup of hot tea and sat down beside him. "
+          "They talked for a long time about the years when the town was still young, about the mill that "
+          "had burned down and about the winter when the river froze so hard that children could skate all "
+          "the way to the next village. Finally the old man opened the letter and read it by the light of "
+          "the lamp. His daughter wrote that she had found a good job in the city and that she would not be "
+          "able to come this year, but that she was thinking of him every day and that she would send him "
+          "photographs of her new apartment. The old man folded the letter carefully, put it back into his "
+          "pocket and thanked the station master for the tea. Then he stood up and walked home through the "
+          "empty streets, humming a song that his wife used to sing when they were both young.";
+
+static void test_recover(struct thread_pool *pool, const char *key)
+{
+    char *encrypted = vigenere_encrypt_simd(key, english_text);
+    char recovered[RECOVER_MAX_KEY + 1];
+    ASSERT(encrypted != NULL);
+
+    ASSERT(vigenere_recover_key(pool, encrypted, strlen(encrypted), RECOVER_MAX_KEY, recovered) == strlen(key));
+    ASSERT(strcmp(recovered, key) == 0);
+    free(encrypted);
+}
+
+TEST(RECOVER)
+{
+    SUBTEST(KEYS)
+    {
+        struct thread_pool pool;
+        ASSERT(thread_pool_init(&pool, 4));
+
+        test_recover(&pool, "LEMON");
+        test_recover(&pool, "KEY");
+        test_recover(&pool, "CIPHER");
+        test_recover(&pool, "ENCRYPTION");
+
+        thread_pool_destroy(&pool);
+    }
+    SUBTEST(NOT_ENOUGH_LETTERS)
+    {
+        struct thread_pool pool;
+        char recovered[RECOVER_MAX_KEY + 1];
+        ASSERT(thread_pool_init(&pool, 1));
+        memset(recovered, 'X', sizeof(recovered));
+        ASSERT(vigenere_recover_key(&pool, "ABC 123", 7, RECOVER_MAX_KEY, recovered) == 0);
+        ASSERT(recovered[0] == '\0');
+
+        memset(recovered, 'X', sizeof(recovered));
+        ASSERT(vigenere_recover_key(&pool, "", 0, RECOVER_MAX_KEY, recovered) == 0);
+        ASSERT(recovered[0] == '\0');
+        thread_pool_destroy(&pool);
+    }
+}
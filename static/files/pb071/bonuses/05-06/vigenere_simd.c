@@ -0,0 +1,274 @@
+#include "vigenere_simd.h"
+
+#include "cipher.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef HAVE_SIMD_KERNELS
+#include <immintrin.h>
+#endif
+
+unsigned char *vigenere_table(const char *key, bool decrypt, size_t *length)
+{
+    if (!key_length(key, length)) {
+        return NULL;
+    }
+
+    unsigned char *table = malloc(*length + VIGENERE_PADDING);
+    if (table != NULL) {
+        vigenere_table_fill(key, *length, decrypt, table);
+    }
+    return table;
+}
+
+void vigenere_table_fill(const char *key, size_t length, bool decrypt, unsigned char *table)
+{
+    for (size_t i = 0; i < length + VIGENERE_PADDING; i++) {
+        unsigned shift = key_shift(key[i % length]);
+        table[i] = (unsigned char) (decrypt ? (ALPHABET_SIZE - shift) % ALPHABET_SIZE : shift);
+    }
+}
+
+static size_t apply_scalar(const unsigned char *table, size_t length_of_key, size_t offset, const unsigned char *in, size_t length, unsigned char *out)
+{
+    for (size_t i = 0; i < length; i++) {
+        unsigned char c = to_upper(in[i]);
+        if (is_letter(c)) {
+            c = shift_letter(c, table[offset]);
+            offset = (offset + 1 == length_of_key) ? 0 : offset + 1;
+        }
+        out[i] = c;
+    }
+    return offset;
+}
+
+/**
+ * @brief Moves the position in the key by the given count of letters.
+ */
+static size_t advance(size_t offset, size_t letters, size_t length_of_key)
+{
+    offset += letters;
+    return offset < length_of_key ? offset : offset % length_of_key;
+}
+
+static size_t count_scalar(const unsigned char *text, size_t length)
+{
+    size_t letters = 0;
+    for (size_t i = 0; i < length; i++) {
+        letters += is_letter(text[i]);
+    }
+    return letters;
+}
+
+#ifdef HAVE_SIMD_KERNELS
+
+/*
+ * Both kernels work the same way:
+ * 1. lowercase letters are uppercased,
+ * 2. letters are found by checking that c - 'A' is below 26 (unsigned minimum
+ *    is used as there is no unsigned comparison),
+ * 3. exclusive prefix sum of the letter flags gives each letter its position
+ *    in the key relative to the offset, shifts are then shuffled from the
+ *    table loaded at the offset,
+ * 4. shifted letter is reduced modulo 26 as min(s, s - 26), which works since
+ *    s - 26 wraps around for s < 26.
+ */
+
+__attribute__((target("ssse3,popcnt"))) static size_t apply_ssse3(const unsigned char *table, size_t length_of_key, size_t offset, const unsigned char *in, size_t length, unsigned char *out)
+{
+    const __m128i a_lower = _mm_set1_epi8('a');
+    const __m128i a_upper = _mm_set1_epi8('A');
+    const __m128i last = _mm_set1_epi8(ALPHABET_SIZE - 1);
+    const __m128i alphabet = _mm_set1_epi8(ALPHABET_SIZE);
+    const __m128i case_bit = _mm_set1_epi8(0x20);
+    const __m128i one = _mm_set1_epi8(1);
+
+    size_t i = 0;
+    for (; i + 16 <= length; i += 16) {
+        __m128i c = _mm_loadu_si128((const __m128i *) (in + i));
+
+        __m128i lower = _mm_sub_epi8(c, a_lower);
+        lower = _mm_cmpeq_epi8(_mm_min_epu8(lower, last), lower);
+        c = _mm_sub_epi8(c, _mm_and_si128(lower, case_bit));
+
+        __m128i index = _mm_sub_epi8(c, a_upper);
+        __m128i letter = _mm_cmpeq_epi8(_mm_min_epu8(index, last), index);
+
+        __m128i flags = _mm_and_si128(letter, one);
+        __m128i rank = _mm_add_epi8(flags, _mm_slli_si128(flags, 1));
+        rank = _mm_add_epi8(rank, _mm_slli_si128(rank, 2));
+        rank = _mm_add_epi8(rank, _mm_slli_si128(rank, 4));
+        rank = _mm_add_epi8(rank, _mm_slli_si128(rank, 8));
+        rank = _mm_sub_epi8(rank, flags);
+
+        __m128i shifts = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) (table + offset)), rank);
+        __m128i shifted = _mm_add_epi8(index, shifts);
+        shifted = _mm_min_epu8(shifted, _mm_sub_epi8(shifted, alphabet));
+        shifted = _mm_add_epi8(shifted, a_upper);
+
+        c = _mm_or_si128(_mm_and_si128(letter, shifted), _mm_andnot_si128(letter, c));
+        _mm_storeu_si128((__m128i *) (out + i), c);
+
+        offset = advance(offset, (size_t) __builtin_popcount((unsigned) _mm_movemask_epi8(letter)), length_of_key);
+    }
+
+    return apply_scalar(table, length_of_key, offset, in + i, length - i, out + i);
+}
+
+__attribute__((target("avx2,popcnt"))) static size_t apply_avx2(const unsigned char *table, size_t length_of_key, size_t offset, const unsigned char *in, size_t length, unsigned char *out)
+{
+    const __m256i a_lower = _mm256_set1_epi8('a');
+    const __m256i a_upper = _mm256_set1_epi8('A');
+    const __m256i last = _mm256_set1_epi8(ALPHABET_SIZE - 1);
+    const __m256i alphabet = _mm256_set1_epi8(ALPHABET_SIZE);
+    const __m256i case_bit = _mm256_set1_epi8(0x20);
+    const __m256i one = _mm256_set1_epi8(1);
+    const __m256i last_in_lane = _mm256_set1_epi8(15);
+
+    size_t i = 0;
+    for (; i + 32 <= length; i += 32) {
+        __m256i c = _mm256_loadu_si256((const __m256i *) (in + i));
+
+        __m256i lower = _mm256_sub_epi8(c, a_lower);
+        lower = _mm256_cmpeq_epi8(_mm256_min_epu8(lower, last), lower);
+        c = _mm256_sub_epi8(c, _mm256_and_si256(lower, case_bit));
+
+        __m256i index = _mm256_sub_epi8(c, a_upper);
+        __m256i letter = _mm256_cmpeq_epi8(_mm256_min_epu8(index, last), index);
+
+        // prefix sums within the 128-bit lanes, then the total of the lower
+        // lane is added to the upper one
+        __m256i flags = _mm256_and_si256(letter, one);
+        __m256i rank = _mm256_add_epi8(flags, _mm256_slli_si256(flags, 1));
+        rank = _mm256_add_epi8(rank, _mm256_slli_si256(rank, 2));
+        rank = _mm256_add_epi8(rank, _mm256_slli_si256(rank, 4));
+        rank = _mm256_add_epi8(rank, _mm256_slli_si256(rank, 8));
+        __m256i total = _mm256_shuffle_epi8(rank, last_in_lane);
+        rank = _mm256_add_epi8(rank, _mm256_permute2x128_si256(total, total, 0x08));
+        rank = _mm256_sub_epi8(rank, flags);
+
+        // shuffles do not cross the lanes, both halves of the shifts are
+        // broadcast and the right one is picked by the rank
+        __m256i window = _mm256_loadu_si256((const __m256i *) (table + offset));
+        __m256i low = _mm256_shuffle_epi8(_mm256_permute2x128_si256(window, window, 0x00), rank);
+        __m256i high = _mm256_shuffle_epi8(_mm256_permute2x128_si256(window, window, 0x11), rank);
+        __m256i shifts = _mm256_blendv_epi8(low, high, _mm256_cmpgt_epi8(rank, last_in_lane));
+
+        __m256i shifted = _mm256_add_epi8(index, shifts);
+        shifted = _mm256_min_epu8(shifted, _mm256_sub_epi8(shifted, alphabet));
+        shifted = _mm256_add_epi8(shifted, a_upper);
+
+        c = _mm256_blendv_epi8(c, shifted, letter);
+        _mm256_storeu_si256((__m256i *) (out + i), c);
+
+        offset = advance(offset, (size_t) __builtin_popcount((unsigned) _mm256_movemask_epi8(letter)), length_of_key);
+    }
+
+    return apply_scalar(table, length_of_key, offset, in + i, length - i, out + i);
+}
+
+__attribute__((target("ssse3,popcnt"))) static size_t count_ssse3(const unsigned char *text, size_t length)
+{
+    const __m128i a_lower = _mm_set1_epi8('a');
+    const __m128i last = _mm_set1_epi8(ALPHABET_SIZE - 1);
+    const __m128i case_bit = _mm_set1_epi8(0x20);
+
+    size_t letters = 0, i = 0;
+    for (; i + 16 <= length; i += 16) {
+        __m128i index = _mm_sub_epi8(_mm_or_si128(_mm_loadu_si128((const __m128i *) (text + i)), case_bit), a_lower);
+        __m128i letter = _mm_cmpeq_epi8(_mm_min_epu8(index, last), index);
+        letters += (size_t) __builtin_popcount((unsigned) _mm_movemask_epi8(letter));
+    }
+    return letters + count_scalar(text + i, length - i);
+}
+
+__attribute__((target("avx2,popcnt"))) static size_t count_avx2(const unsigned char *text, size_t length)
+{
+    const __m256i a_lower = _mm256_set1_epi8('a');
+    const __m256i last = _mm256_set1_epi8(ALPHABET_SIZE - 1);
+    const __m256i case_bit = _mm256_set1_epi8(0x20);
+
+    size_t letters = 0, i = 0;
+    for (; i + 32 <= length; i += 32) {
+        __m256i index = _mm256_sub_epi8(_mm256_or_si256(_mm256_loadu_si256((const __m256i *) (text + i)), case_bit), a_lower);
+        __m256i letter = _mm256_cmpeq_epi8(_mm256_min_epu8(index, last), index);
+        letters += (size_t) __builtin_popcount((unsigned) _mm256_movemask_epi8(letter));
+    }
+    return letters + count_scalar(text + i, length - i);
+}
+
+#endif
+
+size_t count_letters(enum simd_level_t level, const unsigned char *text, size_t length)
+{
+#ifdef HAVE_SIMD_KERNELS
+    switch (simd_supported(level)) {
+    case SIMD_AVX2:
+        return count_avx2(text, length);
+    case SIMD_SSSE3:
+        return count_ssse3(text, length);
+    default:
+        break;
+    }
+#else
+    (void) level;
+#endif
+    return count_scalar(text, length);
+}
+
+size_t vigenere_apply(enum simd_level_t level,
+        const unsigned char *table,
+        size_t length_of_key,
+        size_t offset,
+        const unsigned char *in,
+        size_t length,
+        unsigned char *out)
+{
+#ifdef HAVE_SIMD_KERNELS
+    switch (simd_supported(level)) {
+    case SIMD_AVX2:
+        return apply_avx2(table, length_of_key, offset, in, length, out);
+    case SIMD_SSSE3:
+        return apply_ssse3(table, length_of_key, offset, in, length, out);
+    default:
+        break;
+    }
+#else
+    (void) level;
+#endif
+    return apply_scalar(table, length_of_key, offset, in, length, out);
+}
+
+static char *vigenere(const char *key, const char *text, bool decrypt)
+{
+    if (text == NULL) {
+        return NULL;
+    }
+
+    size_t length_of_key;
+    unsigned char *table = vigenere_table(key, decrypt, &length_of_key);
+    if (table == NULL) {
+        return NULL;
+    }
+
+    size_t length = strlen(text);
+    char *result = malloc(length + 1);
+    if (result != NULL) {
+        vigenere_apply(SIMD_AVX2, table, length_of_key, 0, (const unsigned char *) text, length, (unsigned char *) result);
+        result[length] = '\0';
+    }
+
+    free(table);
+    return result;
+}
+
+char *vigenere_encrypt_simd(const char *key, const char *text)
+{
+    return vigenere(key, text, false);
+}
+
+char *vigenere_decrypt_simd(const char *key, const char *text)
+{
+    return vigenere(key, text, true);
+}
@@ -0,0 +1,89 @@
+#ifndef _VIGENERE_SIMD_H
+#define _VIGENERE_SIMD_H
+
+#include "simd.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * Count of the entries after the end of the key in the table of shifts, so that
+ * the vectorized kernels can load the shifts for the whole vector from any
+ * offset within the key.
+ */
+#define VIGENERE_PADDING 32
+
+/**
+ * @brief Expands the key into the table of shifts used by the kernels.
+ * @param key Key of the Vigenère cipher, single case-insensitive word
+ * consisting of only alphabetical characters.
+ * @param decrypt Whether the table is used for decryption; shifts are then
+ * complemented, so that decryption is also done by shifting forward.
+ * @param length Output variable where the length of the key is stored.
+ * @returns Table of <code>length + VIGENERE_PADDING</code> shifts (key repeated),
+ * or <code>NULL</code> if the key is invalid or the memory could not be
+ * allocated. Table is to be freed by the caller.
+ */
+unsigned char *vigenere_table(const char *key, bool decrypt, size_t *length);
+
+/**
+ * @brief Same as <code>vigenere_table</code>, but the table is stored in the
+ * given buffer.
+ * @param key Valid key of the Vigenère cipher.
+ * @param length Length of the key.
+ * @param decrypt Whether the table is used for decryption.
+ * @param table Buffer of <code>length + VIGENERE_PADDING</code> shifts.
+ */
+void vigenere_table_fill(const char *key, size_t length, bool decrypt, unsigned char *table);
+
+/**
+ * @brief Applies the Vigenère cipher on the block of the text; text is
+ * uppercased, letters are shifted and other characters are passed through.
+ *
+ * Vectorized kernels classify the characters and compute the position in the
+ * key of each letter (count of the letters before it) with masks and prefix
+ * sums, there are no branches per character.
+ *
+ * @param level Instruction set to be used, it is limited to the ones supported
+ * by the CPU.
+ * @param table Table of the shifts created by <code>vigenere_table</code>.
+ * @param length_of_key Length of the key.
+ * @param offset Position in the key where the block starts.
+ * @param in Block of the text.
+ * @param length Length of the block.
+ * @param out Output buffer of <code>length</code> characters, can be the same
+ * as the input.
+ * @returns Position in the key where the next block starts.
+ */
+size_t vigenere_apply(enum simd_level_t level,
+        const unsigned char *table,
+        size_t length_of_key,
+        size_t offset,
+        const unsigned char *in,
+        size_t length,
+        unsigned char *out);
+
+/**
+ * @brief Counts the letters (of both cases) in the block of the text, i.e. how
+ * far the block moves the position in the key.
+ * @param level Instruction set to be used, it is limited to the ones supported
+ * by the CPU.
+ * @param text Block of the text.
+ * @param length Length of the block.
+ * @returns Count of the letters.
+ */
+size_t count_letters(enum simd_level_t level, const unsigned char *text, size_t length);
+
+/**
+ * Same as vigenere_encrypt() but the fastest kernel supported by the CPU is
+ * used.
+ */
+char *vigenere_encrypt_simd(const char *key, const char *text);
+
+/**
+ * Same as vigenere_decrypt() but the fastest kernel supported by the CPU is
+ * used.
+ */
+char *vigenere_decrypt_simd(const char *key, const char *text);
+
+#endif
@@ -0,0 +1,170 @@
+#include "aho.h"
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** Transition that is not in the trie (yet). */
+#define MISSING UINT32_MAX
+
+/**
+ * @brief Assigns classes to the bytes of the substrings, both cases of a letter
+ * share the class. Class 0 is left for the bytes that are not in any substring.
+ * @param automaton Automaton whose classes are assigned.
+ * @param count Count of the substrings.
+ * @param patterns Substrings.
+ */
+static void assign_classes(struct aho_corasick *automaton, size_t count, const char *const *patterns)
+{
+    memset(automaton->byte_classes, 0, sizeof(automaton->byte_classes));
+    automaton->classes = 1;
+
+    for (size_t i = 0; i < count; i++) {
+        for (const unsigned char *byte = (const unsigned char *) patterns[i]; *byte != '\0'; byte++) {
+            int lower = tolower(*byte);
+            if (automaton->byte_classes[lower] == 0) {
+                automaton->byte_classes[lower] = (unsigned char) automaton->classes;
+                automaton->byte_classes[toupper(lower)] = (unsigned char) automaton->classes;
+                automaton->classes++;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Inserts the substrings into the trie.
+ * @param automaton Automaton with the allocated tables.
+ * @param count Count of the substrings.
+ * @param patterns Substrings.
+ */
+static void build_trie(struct aho_corasick *automaton, size_t count, const char *const *patterns)
+{
+    automaton->states = 1;
+
+    for (size_t i = 0; i < count; i++) {
+        uint32_t state = 0;
+        for (const unsigned char *byte = (const unsigned char *) patterns[i]; *byte != '\0'; byte++) {
+            uint32_t *next = &automaton->next[state * automaton->classes + automaton->byte_classes[*byte]];
+            if (*next == MISSING) {
+                *next = (uint32_t) automaton->states++;
+            }
+            state = *next;
+        }
+        automaton->terminals[i] = patterns[i][0] == '\0' ? UINT32_MAX : state;
+    }
+}
+
+/**
+ * @brief Resolves the failure links and fills in the missing transitions, states
+ * are processed in the breadth-first order, so the failure link of each state
+ * leads to an already resolved one.
+ * @param automaton Automaton with the trie built.
+ */
+static void resolve_links(struct aho_corasick *automaton)
+{
+    size_t classes = automaton->classes;
+    uint32_t *next = automaton->next;
+    size_t head = 0;
+    size_t tail = 0;
+
+    automaton->fail[0] = 0;
+    automaton->order[tail++] = 0;
+
+    while (head < tail) {
+        uint32_t state = automaton->order[head++];
+        uint32_t fail = automaton->fail[state];
+
+        for (size_t c = 0; c < classes; c++) {
+            uint32_t *target = &next[state * classes + c];
+            if (*target == MISSING) {
+                *target = state == 0 ? 0 : next[fail * classes + c];
+                continue;
+            }
+
+            automaton->fail[*target] = state == 0 ? 0 : next[fail * classes + c];
+            automaton->order[tail++] = *target;
+        }
+    }
+}
+
+bool aho_init(struct aho_corasick *automaton, size_t count, const char *const *patterns)
+{
+    size_t total = 0;
+    automaton->longest = 0;
+    for (size_t i = 0; i < count; i++) {
+        size_t length = strlen(patterns[i]);
+        total += length;
+        if (length > automaton->longest) {
+            automaton->longest = length;
+        }
+    }
+
+    assign_classes(automaton, count, patterns);
+    automaton->patterns = count;
+
+    // states are indexed by 32-bit numbers, the table must fit as well
+    size_t max_states = total + 1;
+    if (max_states > UINT32_MAX / automaton->classes) {
+        return false;
+    }
+
+    automaton->next = malloc(max_states * automaton->classes * sizeof(uint32_t));
+    automaton->fail = malloc(max_states * sizeof(uint32_t));
+    automaton->order = malloc(max_states * sizeof(uint32_t));
+    automaton->terminals = malloc((count > 0 ? count : 1) * sizeof(uint32_t));
+    if (automaton->next == NULL || automaton->fail == NULL || automaton->order == NULL || automaton->terminals == NULL) {
+        aho_destroy(automaton);
+        return false;
+    }
+
+    memset(automaton->next, 0xFF, max_states * automaton->classes * sizeof(uint32_t));
+    build_trie(automaton, count, patterns);
+    resolve_links(automaton);
+    return true;
+}
+
+void aho_destroy(struct aho_corasick *automaton)
+{
+    free(automaton->next);
+    free(automaton->fail);
+    free(automaton->order);
+    free(automaton->terminals);
+    automaton->next = automaton->fail = automaton->order = automaton->terminals = NULL;
+}
+
+void aho_scan(const struct aho_corasick *automaton, uint32_t *state, size_t *visits, const unsigned char *data, size_t length)
+{
+    // locals, since the data could alias the automaton otherwise
+    const uint32_t *next = automaton->next;
+    const unsigned char *byte_classes = automaton->byte_classes;
+    size_t classes = automaton->classes;
+    uint32_t current = *state;
+
+    if (visits == NULL) {
+        for (size_t i = 0; i < length; i++) {
+            current = next[current * classes + byte_classes[data[i]]];
+        }
+    } else {
+        for (size_t i = 0; i < length; i++) {
+            current = next[current * classes + byte_classes[data[i]]];
+            visits[current]++;
+        }
+    }
+
+    *state = current;
+}
+
+void aho_counts(const struct aho_corasick *automaton, size_t *visits, size_t *counts)
+{
+    // each visit of a state is an occurence of all its suffixes as well,
+    // deeper states are added to their failure links first
+    for (size_t i = automaton->states; i-- > 1;) {
+        uint32_t state = automaton->order[i];
+        visits[automaton->fail[state]] += visits[state];
+    }
+
+    for (size_t i = 0; i < automaton->patterns; i++) {
+        uint32_t terminal = automaton->terminals[i];
+        counts[i] = terminal == UINT32_MAX ? 0 : visits[terminal];
+    }
+}
@@ -0,0 +1,78 @@
+#ifndef _AHO_H
+#define _AHO_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Aho-Corasick automaton that counts occurences of multiple substrings
+ * in a single pass, letters are compared without regard to their case.
+ *
+ * Bytes are mapped to classes first (one class for each distinct byte of the
+ * substrings and one for all the others), transitions are kept in a single
+ * flat table with a row of classes per state, so the rows are small and
+ * neighbouring states share the cache lines. Scanning only counts the visits
+ * of the states; occurences of each substring are summed from the visits of
+ * all states it is a suffix of after the scan.
+ */
+struct aho_corasick
+{
+    size_t patterns;
+    size_t states;
+    size_t classes;
+    /** Class of each byte. */
+    unsigned char byte_classes[256];
+    /** Transitions, each one holds the number of the next state, row of the
+     * state <code>s</code> starts at <code>s * classes</code>. State numbers
+     * are kept instead of the starts of the rows, since they index the
+     * visits as well. */
+    uint32_t *next;
+    /** Longest proper suffix of each state that is a state too. */
+    uint32_t *fail;
+    /** States in the breadth-first order, i.e. sorted by their depth. */
+    uint32_t *order;
+    /** State of each substring, <code>UINT32_MAX</code> for an empty one. */
+    uint32_t *terminals;
+    /** Length of the longest substring. */
+    size_t longest;
+};
+
+/**
+ * @brief Builds the automaton.
+ * @param automaton Automaton to be initialized.
+ * @param count Count of the substrings.
+ * @param patterns Substrings to be counted, duplicates are allowed.
+ * @returns <code>true</code> if the automaton has been built, <code>false</code>
+ * if the memory could not be allocated or there are too many states.
+ */
+bool aho_init(struct aho_corasick *automaton, size_t count, const char *const *patterns);
+
+/**
+ * @brief Frees the memory held by the automaton.
+ * @param automaton Automaton to be destroyed.
+ */
+void aho_destroy(struct aho_corasick *automaton);
+
+/**
+ * @brief Scans the block of the data. Data can be passed in any number of
+ * blocks, the state is carried over.
+ * @param automaton Built automaton.
+ * @param state Current state, 0 before the first block; updated.
+ * @param visits Visits of each state (<code>automaton->states</code> counters),
+ * zeroed before the first block; updated. In case it is <code>NULL</code>, the
+ * state is only advanced (e.g. over the data before the start of a chunk).
+ * @param data Block of the data.
+ * @param length Length of the block.
+ */
+void aho_scan(const struct aho_corasick *automaton, uint32_t *state, size_t *visits, const unsigned char *data, size_t length);
+
+/**
+ * @brief Converts the visits into the counts of the substrings.
+ * @param automaton Built automaton.
+ * @param visits Visits from <code>aho_scan</code>, they are overwritten.
+ * @param counts Output array for the count of each substring.
+ */
+void aho_counts(const struct aho_corasick *automaton, size_t *visits, size_t *counts);
+
+#endif
@@ -0,0 +1,139 @@
+#include "matcher.h"
+#include "parallel.h"
+#include "pool.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define DEFAULT_MEGABYTES 256
+#define DEFAULT_ROUNDS 3
+#define WORDS 4
+
+static const char *kind_names[] = { "search", "dfa", "multi" };
+static const char *words[WORDS] = { "ananas", "lorem", "ipsum", "dolor" };
+
+/**
+ * @brief Returns current time of the monotonic clock.
+ * @returns Time in seconds.
+ */
+static double now_seconds(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double) now.tv_sec + (double) now.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Fills the buffer with the input of the test case, repeated.
+ * @param buffer Buffer to be filled.
+ * @param length Length of the buffer.
+ * @returns <code>true</code> if the buffer has been filled, <code>false</code>
+ * if the input could not be read.
+ */
+static bool fill(unsigned char *buffer, size_t length)
+{
+    FILE *file = fopen("test-counting/lorem_some.in", "rb");
+    if (file == NULL) {
+        return false;
+    }
+    size_t size = fread(buffer, 1, length, file);
+    fclose(file);
+    if (size == 0) {
+        return false;
+    }
+
+    for (size_t offset = size; offset < length; offset += size) {
+        memcpy(buffer + offset, buffer, offset + size <= length ? size : length - offset);
+    }
+    return true;
+}
+
+/**
+ * @brief Measures one matcher on growing count of the threads.
+ * @param matcher Matcher to be measured.
+ * @param data Data to be searched.
+ * @param length Length of the data.
+ * @param max_threads Highest count of the threads.
+ * @param rounds Count of the rounds.
+ * @returns <code>true</code> if the parallel counts match the sequential
+ * ones, <code>false</code> otherwise.
+ */
+static bool measure(const struct matcher *matcher, const unsigned char *data, size_t length, size_t max_threads, size_t rounds)
+{
+    size_t expected[WORDS];
+    size_t counts[WORDS];
+    struct scan scan;
+    if (!scan_init(matcher, &scan)) {
+        return false;
+    }
+
+    double start = now_seconds();
+    scan_block(matcher, &scan, data, length);
+    double serial = now_seconds() - start;
+    scan_finish(matcher, &scan, expected);
+    printf("%-8s %-8s %10.2f %10s\n", kind_names[matcher->kind], "serial", length / serial / 1e9, "-");
+
+    bool valid = true;
+    double base = 0;
+    for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+        struct thread_pool pool;
+        if (!thread_pool_init(&pool, threads)) {
+            return false;
+        }
+
+        double elapsed = 0;
+        for (size_t round = 0; round < rounds; round++) {
+            start = now_seconds();
+            valid = count_parallel(&pool, matcher, data, length, 0, counts) && valid;
+            elapsed += now_seconds() - start;
+            valid = valid && memcmp(counts, expected, matcher->patterns * sizeof(size_t)) == 0;
+        }
+        thread_pool_destroy(&pool);
+
+        if (threads == 1) {
+            base = elapsed;
+        }
+        printf("%-8s %-8zu %10.2f %10.2f\n", kind_names[matcher->kind], threads, (double) length * rounds / elapsed / 1e9, base / elapsed);
+    }
+
+    if (!valid) {
+        fprintf(stderr, "Parallel counts of %s differ from the serial ones\n", kind_names[matcher->kind]);
+    }
+    return valid;
+}
+
+int main(int argc, char **argv)
+{
+    size_t length = (argc > 1 ? strtoul(argv[1], NULL, 10) : DEFAULT_MEGABYTES) << 20;
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t max_threads = argc > 2 ? strtoul(argv[2], NULL, 10) : (online > 0 ? (size_t) online : 1);
+    size_t rounds = argc > 3 ? strtoul(argv[3], NULL, 10) : DEFAULT_ROUNDS;
+
+    unsigned char *data = malloc(length);
+    if (data == NULL || !fill(data, length)) {
+        fprintf(stderr, "Could not prepare the data (run it from the directory with tests)\n");
+        free(data);
+        return 1;
+    }
+
+    printf("%-8s %-8s %10s %10s\n", "matcher", "threads", "GB/s", "speedup");
+    int result = 0;
+    for (int kind = MATCH_SEARCH; kind <= MATCH_MULTI; kind++) {
+        struct matcher matcher;
+        if (!matcher_init(&matcher, kind == MATCH_MULTI ? WORDS : 1, words, kind == MATCH_DFA)) {
+            fprintf(stderr, "Could not prepare the matcher\n");
+            result = 1;
+            continue;
+        }
+        if (!measure(&matcher, data, length, max_threads, rounds)) {
+            result = 1;
+        }
+        matcher_destroy(&matcher);
+    }
+
+    free(data);
+    return result;
+}
@@ -0,0 +1,203 @@
+#include "dfa.h"
+#include "search.h"
+#include "simd.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define DEFAULT_MEGABYTES 64
+#define DEFAULT_ROUNDS 3
+
+static const char *level_names[] = { "scalar", "sse2", "avx2" };
+
+/**
+ * @brief Test case from the <code>test-counting</code> directory.
+ */
+struct bench_case
+{
+    const char *name;
+    const char *substring;
+};
+
+static const struct bench_case cases[] = {
+    { "basic", "ananas" },
+    { "fgetc", "getc" },
+    { "going_bananas", "banana" },
+    { "lorem_empty", "ananas" },
+    { "lorem_some", "ananas" },
+    { "mmap", "mmap" },
+    { "never_enough_random", "ananas" },
+    { "nothing_to_see", "ananas" },
+    { "random", "ananas" },
+    { "random_again", "ananas" },
+    { "tricky", "ananas" },
+};
+
+#define CASES (sizeof(cases) / sizeof(cases[0]))
+
+/**
+ * @brief Returns current time of the monotonic clock.
+ * @returns Time in seconds.
+ */
+static double now_seconds(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double) now.tv_sec + (double) now.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Loads the whole file.
+ * @param path Path to the file.
+ * @param length Output parameter for the length of the file.
+ * @returns Contents of the file that are to be freed by the caller, or <code>
+ * NULL</code> if the file could not be read.
+ */
+static unsigned char *load(const char *path, size_t *length)
+{
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) {
+        return NULL;
+    }
+
+    size_t capacity = 4096;
+    unsigned char *data = malloc(capacity);
+    *length = 0;
+    size_t count;
+    while (data != NULL && (count = fread(data + *length, 1, capacity - *length, file)) > 0) {
+        *length += count;
+        if (*length == capacity) {
+            capacity *= 2;
+            unsigned char *bigger = realloc(data, capacity);
+            if (bigger == NULL) {
+                free(data);
+            }
+            data = bigger;
+        }
+    }
+
+    fclose(file);
+    return data;
+}
+
+/**
+ * @brief Reads the expected count from the output of the test case.
+ * @param name Name of the test case.
+ * @returns Expected count, or -1 if it could not be read.
+ */
+static long expected_count(const char *name)
+{
+    char path[256];
+    snprintf(path, sizeof(path), "test-counting/%s.out", name);
+    FILE *file = fopen(path, "r");
+    long count = -1;
+    if (file != NULL) {
+        if (fscanf(file, "%ld", &count) != 1) {
+            count = -1;
+        }
+        fclose(file);
+    }
+    return count;
+}
+
+/**
+ * @brief Measures all the kernels on one test case, its input is repeated
+ * to fill the buffer of the given length.
+ * @param bench Test case.
+ * @param length Length of the buffer.
+ * @param rounds Count of the rounds.
+ * @returns <code>true</code> if all kernels agree with the expected output,
+ * <code>false</code> otherwise.
+ */
+static bool measure(const struct bench_case *bench, size_t length, size_t rounds)
+{
+    char path[256];
+    snprintf(path, sizeof(path), "test-counting/%s.in", bench->name);
+
+    size_t size;
+    unsigned char *input = load(path, &size);
+    unsigned char *buffer = malloc(length);
+    struct pattern pattern;
+    if (input == NULL || size == 0 || buffer == NULL || !pattern_init(&pattern, bench->substring)) {
+        fprintf(stderr, "Could not load %s\n", path);
+        free(buffer);
+        free(input);
+        return false;
+    }
+
+    bool valid = true;
+    long expected = expected_count(bench->name);
+    for (int level = SIMD_SCALAR; level < SIMD_LEVELS; level++) {
+        if ((long) pattern_count_simd(level, &pattern, input, size) != expected) {
+            fprintf(stderr, "%s: %s kernel differs from the expected count %ld\n", bench->name, level_names[level], expected);
+            valid = false;
+        }
+    }
+
+    for (size_t offset = 0; offset < length; offset += size) {
+        memcpy(buffer + offset, input, offset + size <= length ? size : length - offset);
+    }
+
+    printf("%-20s", bench->name);
+    double elapsed[SIMD_LEVELS];
+    size_t counts[SIMD_LEVELS];
+    for (int level = SIMD_SCALAR; level < SIMD_LEVELS; level++) {
+        double start = now_seconds();
+        for (size_t round = 0; round < rounds; round++) {
+            counts[level] = pattern_count_simd(level, &pattern, buffer, length);
+        }
+        elapsed[level] = now_seconds() - start;
+        printf(" %10.2f", (double) length * rounds / elapsed[level] / 1e9);
+
+        if (counts[level] != counts[SIMD_SCALAR]) {
+            valid = false;
+        }
+    }
+
+    struct dfa dfa;
+    if (dfa_compile(&dfa, bench->substring)) {
+        unsigned state = 0;
+        if ((long) dfa_count(&dfa, &state, input, size) != expected) {
+            fprintf(stderr, "%s: automaton differs from the expected count %ld\n", bench->name, expected);
+            valid = false;
+        }
+
+        size_t count = 0;
+        double start = now_seconds();
+        for (size_t round = 0; round < rounds; round++) {
+            state = 0;
+            count = dfa_count(&dfa, &state, buffer, length);
+        }
+        printf(" %10.2f", (double) length * rounds / (now_seconds() - start) / 1e9);
+        valid = valid && count == counts[SIMD_SCALAR];
+    }
+    printf(" %10.2f\n", elapsed[SIMD_SCALAR] / elapsed[SIMD_LEVELS - 1]);
+
+    pattern_destroy(&pattern);
+    free(buffer);
+    free(input);
+    return valid;
+}
+
+int main(int argc, char **argv)
+{
+    size_t length = (argc > 1 ? strtoul(argv[1], NULL, 10) : DEFAULT_MEGABYTES) << 20;
+    size_t rounds = argc > 2 ? strtoul(argv[2], NULL, 10) : DEFAULT_ROUNDS;
+
+    printf("Best kernel supported by the CPU: %s\n", level_names[simd_detect()]);
+    printf("%-20s", "input [GB/s]");
+    for (int level = SIMD_SCALAR; level < SIMD_LEVELS; level++) {
+        printf(" %10s", level_names[level]);
+    }
+    printf(" %10s %10s\n", "dfa", "speedup");
+
+    int result = 0;
+    for (size_t i = 0; i < CASES; i++) {
+        if (!measure(&cases[i], length, rounds)) {
+            result = 1;
+        }
+    }
+    return result;
+}
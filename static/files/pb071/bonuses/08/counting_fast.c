@@ -0,0 +1,434 @@
+#include "files.h"
+#include "mapped.h"
+#include "matcher.h"
+#include "parallel.h"
+#include "patterns.h"
+#include "reader.h"
+
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * Most threads that can be requested by <code>-j</code>.
+ */
+#define MAX_THREADS 1024
+
+/**
+ * @brief Writes given number to the file, character by character.
+ * @param file File where the number is supposed to be written.
+ * @param number Number to be written.
+ */
+static void write_number(FILE *file, long number)
+{
+    if (number >= 10) {
+        write_number(file, number / 10);
+    }
+    fputc('0' + number % 10, file);
+}
+
+/**
+ * @brief Parses size with an optional suffix K or M (powers of 1024).
+ * @param text Text to be parsed.
+ * @returns Size in bytes, or 0 if the text is not a valid size.
+ */
+static size_t parse_size(const char *text)
+{
+    char *end;
+    size_t size = strtoul(text, &end, 10);
+    switch (*end) {
+    case 'M':
+        size <<= 10;
+        // fall through
+    case 'K':
+        size <<= 10;
+        end++;
+        break;
+    }
+    return *end == '\0' ? size : 0;
+}
+
+/**
+ * @brief Parses the count of the threads.
+ * @param text Text to be parsed.
+ * @param threads Output parameter for the count of the threads.
+ * @returns <code>true</code> if the text is a number from 0 to <code>
+ * MAX_THREADS</code>, <code>false</code> otherwise.
+ */
+static bool parse_threads(const char *text, size_t *threads)
+{
+    // strtoul would skip the whitespace and accept negative numbers
+    if (!isdigit((unsigned char) text[0])) {
+        return false;
+    }
+
+    char *end;
+    errno = 0;
+    unsigned long count = strtoul(text, &end, 10);
+    if (errno != 0 || *end != '\0' || count > MAX_THREADS) {
+        return false;
+    }
+
+    *threads = count;
+    return true;
+}
+
+/**
+ * @brief Options of the program.
+ */
+struct options
+{
+    size_t block_size;
+    bool stream;
+    bool automaton;
+    const char *pattern_file;
+    size_t threads;
+    /** Whether the count of the threads has been given by <code>-j</code>. */
+    bool threads_given;
+    size_t chunk_size;
+};
+
+/**
+ * @brief Counts occurences of the substrings in the data mapped from the file,
+ * in parallel if more threads are requested.
+ * @param options Options of the program.
+ * @param matcher Substrings to be counted.
+ * @param data Mapped data.
+ * @param length Length of the data.
+ * @param counts Output array for the count of each substring.
+ * @returns <code>true</code> if the data have been counted, <code>false
+ * </code> otherwise.
+ */
+static bool count_mapped(const struct options *options, const struct matcher *matcher, const unsigned char *data, size_t length, size_t *counts)
+{
+    if (options->threads != 1) {
+        struct thread_pool pool;
+        if (!thread_pool_init(&pool, options->threads)) {
+            return false;
+        }
+        bool counted = count_parallel(&pool, matcher, data, length, options->chunk_size, counts);
+        thread_pool_destroy(&pool);
+        return counted;
+    }
+
+    struct scan scan;
+    if (!scan_init(matcher, &scan)) {
+        return false;
+    }
+    scan_block(matcher, &scan, data, length);
+    scan_finish(matcher, &scan, counts);
+    return true;
+}
+
+/**
+ * @brief Counts occurences of the substrings in the file, regular files are
+ * mapped into the memory, others (and compressed ones) are read block by
+ * block.
+ * @param fd Descriptor of the file.
+ * @param options Options of the program.
+ * @param matcher Substrings to be counted.
+ * @param counts Output array for the count of each substring.
+ * @returns <code>COUNT_OK</code> if the whole file has been searched, the
+ * reason of the failure otherwise.
+ */
+static enum count_status_t count_file(int fd, const struct options *options, const struct matcher *matcher, size_t *counts)
+{
+    struct mapped_file file;
+    if (options->stream || !mapped_file_open(&file, fd)) {
+        return count_stream(fd, matcher, options->block_size, counts);
+    }
+
+    // compressed files are decompressed by the reader, block by block
+    if (compression_detect(file.data, file.length) != COMPRESSION_NONE) {
+        mapped_file_close(&file);
+        return count_stream(fd, matcher, options->block_size, counts);
+    }
+
+    bool counted = count_mapped(options, matcher, file.data, file.length, counts);
+    mapped_file_close(&file);
+    return counted ? COUNT_OK : COUNT_FAILED;
+}
+
+/**
+ * @brief Writes the count of each substring on a separate line.
+ * @param path Path to the output file.
+ * @param counts Counts of the substrings.
+ * @param count Count of the substrings.
+ * @returns <code>true</code> if the counts have been written, <code>false
+ * </code> otherwise.
+ */
+static bool write_counts(const char *path, const size_t *counts, size_t count)
+{
+    FILE *output = fopen(path, "w");
+    if (output == NULL) {
+        return false;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        write_number(output, (long) counts[i]);
+        fputc('\n', output);
+    }
+    return fclose(output) != EOF;
+}
+
+/**
+ * @brief Writes the counts of the substrings separated by spaces, followed by
+ * the name, on a single line.
+ * @param output Output file.
+ * @param counts Counts of the substrings.
+ * @param count Count of the substrings.
+ * @param name Name of the file, or <code>total</code>.
+ */
+static void write_row(FILE *output, const size_t *counts, size_t count, const char *name)
+{
+    for (size_t i = 0; i < count; i++) {
+        write_number(output, (long) counts[i]);
+        fputc(' ', output);
+    }
+    fputs(name, output);
+    fputc('\n', output);
+}
+
+/**
+ * @brief Writes the counts of each file that has been read and the total
+ * counts on the last line.
+ * @param path Path to the output file.
+ * @param files Files that have been counted.
+ * @param counts Rows of the counts of each file.
+ * @param failed Flag for each file that could not be read.
+ * @param count Count of the substrings.
+ * @returns <code>true</code> if the counts have been written, <code>false
+ * </code> otherwise.
+ */
+static bool write_rows(const char *path, const struct file_list *files, const size_t *counts, const bool *failed, size_t count)
+{
+    size_t *total = calloc(count, sizeof(size_t));
+    FILE *output = total != NULL ? fopen(path, "w") : NULL;
+    if (output == NULL) {
+        free(total);
+        return false;
+    }
+
+    for (size_t i = 0; i < files->count; i++) {
+        if (failed[i]) {
+            continue;
+        }
+        write_row(output, counts + i * count, count, files->files[i].path);
+        for (size_t j = 0; j < count; j++) {
+            total[j] += counts[i * count + j];
+        }
+    }
+    write_row(output, total, count, "total");
+
+    free(total);
+    return fclose(output) != EOF;
+}
+
+/**
+ * @brief Counts the substrings in the single input file and writes the counts.
+ * @param options Options of the program.
+ * @param matcher Substrings to be counted.
+ * @param input Path to the input file.
+ * @param output Path to the output file.
+ * @returns Exit code of the program.
+ */
+static int run_file(const struct options *options, const struct matcher *matcher, const char *input, const char *output)
+{
+    size_t *counts = malloc(matcher->patterns * sizeof(size_t));
+    int fd = open(input, O_RDONLY);
+    enum count_status_t status = counts != NULL && fd != -1 ? count_file(fd, options, matcher, counts) : COUNT_FAILED;
+    int result = 0;
+    if (status != COUNT_OK) {
+        fprintf(stderr, "Could not read the input file %s%s\n", input, status == COUNT_UNSUPPORTED ? " (compression is not supported)" : "");
+        result = 2;
+    } else if (!write_counts(output, counts, matcher->patterns)) {
+        fprintf(stderr, "Could not write the output file %s\n", output);
+        result = 3;
+    }
+
+    if (fd != -1) {
+        close(fd);
+    }
+    free(counts);
+    return result;
+}
+
+/**
+ * @brief Counts the substrings in all files from the directory or matched by
+ * the pattern, writes the counts of each file and the total counts.
+ * @param options Options of the program.
+ * @param matcher Substrings to be counted.
+ * @param input Path to the directory or the pattern.
+ * @param output Path to the output file.
+ * @returns Exit code of the program.
+ */
+static int run_files(const struct options *options, const struct matcher *matcher, const char *input, const char *output)
+{
+    struct file_list files;
+    files_init(&files);
+    if (!files_collect(&files, input)) {
+        fprintf(stderr, "Could not find the input files %s\n", input);
+        files_destroy(&files);
+        return 2;
+    }
+
+    // files are counted by all processors unless told otherwise
+    struct thread_pool pool;
+    size_t *counts = malloc((files.count > 0 ? files.count : 1) * matcher->patterns * sizeof(size_t));
+    bool *failed = malloc((files.count > 0 ? files.count : 1) * sizeof(bool));
+    if (counts == NULL || failed == NULL || !thread_pool_init(&pool, options->threads_given ? options->threads : 0)) {
+        fprintf(stderr, "Could not allocate the counts\n");
+        free(counts);
+        free(failed);
+        files_destroy(&files);
+        return 2;
+    }
+
+    int result = 0;
+    if (!count_files(&pool, matcher, &files, options->chunk_size, counts, failed)) {
+        fprintf(stderr, "Could not allocate the counts\n");
+        result = 2;
+    } else {
+        for (size_t i = 0; i < files.count; i++) {
+            if (failed[i]) {
+                fprintf(stderr, "Could not read the input file %s\n", files.files[i].path);
+                result = 2;
+            }
+        }
+        if (!write_rows(output, &files, counts, failed, matcher->patterns)) {
+            fprintf(stderr, "Could not write the output file %s\n", output);
+            result = 3;
+        }
+    }
+
+    thread_pool_destroy(&pool);
+    free(counts);
+    free(failed);
+    files_destroy(&files);
+    return result;
+}
+
+/**
+ * @brief Counts the substrings in the input and writes the counts.
+ * @param options Options of the program.
+ * @param patterns Substrings to be counted, at least one.
+ * @param input Path to the input file, the directory or the pattern.
+ * @param output Path to the output file.
+ * @returns Exit code of the program.
+ */
+static int run(const struct options *options, const struct pattern_list *patterns, const char *input, const char *output)
+{
+    // automaton for a single substring has a fixed size, it lives on the stack
+    struct matcher matcher;
+    if (!matcher_init(&matcher, patterns->count, (const char *const *) patterns->items, options->automaton)) {
+        fprintf(stderr, "Could not prepare the strings (at most %d characters for -d)\n", DFA_MAX_PATTERN);
+        return 1;
+    }
+
+    // anything but a directory that exists is a single file, e.g. a pipe
+    struct stat info;
+    bool single = stat(input, &info) == 0 && !S_ISDIR(info.st_mode);
+    int result = single ? run_file(options, &matcher, input, output) : run_files(options, &matcher, input, output);
+
+    matcher_destroy(&matcher);
+    return result;
+}
+
+/**
+ * @brief Main function of a program.
+ * @returns Exit code that denotes following:
+ *      0 in case of success
+ *      1 in case of invalid usage
+ *      2 in case of failure on input file
+ *      3 in case of failure on output file
+ */
+int main(int argc, char **argv)
+{
+    struct options options = { READER_BLOCK_SIZE, false, false, NULL, 1, false, 0 };
+    bool valid = true;
+
+    int option;
+    while ((option = getopt(argc, argv, "b:sdp:j:c:")) != -1) {
+        switch (option) {
+        case 'b':
+            options.block_size = parse_size(optarg);
+            valid = valid && options.block_size > 0;
+            break;
+        case 's':
+            options.stream = true;
+            break;
+        case 'd':
+            options.automaton = true;
+            break;
+        case 'p':
+            options.pattern_file = optarg;
+            break;
+        case 'j':
+            valid = valid && parse_threads(optarg, &options.threads);
+            options.threads_given = true;
+            break;
+        case 'c':
+            options.chunk_size = parse_size(optarg);
+            valid = valid && options.chunk_size > 0;
+            break;
+        default:
+            valid = false;
+            break;
+        }
+    }
+
+    int first = optind;
+    if (!valid || argc - first < 2) {
+        printf("Usage: %s [-d] [-s] [-b block-size] [-j threads [-c chunk-size]] [-p pattern-file]\n", argv[0]);
+        printf("       <input-file|directory|pattern> <output-file> [string-to-be-counted...]\n");
+        printf("  -d  count by the automaton that reads each byte exactly once, the string\n");
+        printf("      can have at most %d characters\n", DFA_MAX_PATTERN);
+        printf("  -s  read regular files by blocks too, instead of mapping them into the memory\n");
+        printf("  -b  size of the blocks that are read at once, suffixes K and M are allowed\n");
+        printf("      (default 1M)\n");
+        printf("  -j  count chunks of the mapped files by the given count of threads in parallel,\n");
+        printf("      0 to use all online processors (at most %d)\n", MAX_THREADS);
+        printf("  -c  size of the chunks for -j (default 4 chunks per thread, at least 1M)\n");
+        printf("  -p  file with more strings to be counted, one per line\n");
+        printf("Count of each string is written on a separate line in the order they are\n");
+        printf("given, multiple strings are counted at once in a single pass.\n");
+        printf("Directory is searched recursively and pattern (e.g. 'logs/*.txt') is expanded,\n");
+        printf("counts of each file are written on its line followed by its path, the last\n");
+        printf("line holds the total counts; all online processors are used unless -j is set.\n");
+        return 1;
+    }
+
+    struct pattern_list patterns = { 0, 0, NULL };
+    bool loaded = true;
+    for (int i = first + 2; loaded && i < argc; i++) {
+        loaded = patterns_add(&patterns, argv[i], strlen(argv[i]));
+    }
+    if (loaded && options.pattern_file != NULL && !patterns_load(&patterns, options.pattern_file)) {
+        fprintf(stderr, "Could not load the strings from %s\n", options.pattern_file);
+        patterns_free(&patterns);
+        return 1;
+    }
+    if (loaded && patterns.count == 0) {
+        if (options.pattern_file != NULL) {
+            fprintf(stderr, "There are no strings in %s\n", options.pattern_file);
+            patterns_free(&patterns);
+            return 1;
+        }
+        loaded = patterns_add(&patterns, "ananas", strlen("ananas"));
+    }
+    if (!loaded) {
+        fprintf(stderr, "Could not allocate the strings\n");
+        patterns_free(&patterns);
+        return 2;
+    }
+
+    int result = run(&options, &patterns, argv[first], argv[first + 1]);
+    patterns_free(&patterns);
+    return result;
+}
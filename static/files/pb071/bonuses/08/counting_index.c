@@ -0,0 +1,158 @@
+#include "index.h"
+#include "patterns.h"
+
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/**
+ * @brief Writes given number to the file, character by character.
+ * @param file File where the number is supposed to be written.
+ * @param number Number to be written.
+ */
+static void write_number(FILE *file, long number)
+{
+    if (number >= 10) {
+        write_number(file, number / 10);
+    }
+    fputc('0' + number % 10, file);
+}
+
+/**
+ * @brief Builds the index of the input file.
+ * @param input Path to the input file.
+ * @param path Path to the index file.
+ * @returns Exit code of the program.
+ */
+static int build(const char *input, const char *path)
+{
+    int fd = open(input, O_RDONLY);
+    if (fd == -1) {
+        fprintf(stderr, "Could not read the input file %s\n", input);
+        return 2;
+    }
+
+    bool built = suffix_index_build(fd, path);
+    close(fd);
+    if (!built) {
+        fprintf(stderr, "Could not build the index %s (regular files up to 4 GiB only)\n", path);
+        return 3;
+    }
+    return 0;
+}
+
+/**
+ * @brief Counts the substrings in the index and writes the count of each one
+ * on a separate line.
+ * @param path Path to the index file.
+ * @param patterns Substrings to be counted.
+ * @param output Path to the output file.
+ * @returns Exit code of the program.
+ */
+static int query(const char *path, const struct pattern_list *patterns, const char *output)
+{
+    struct suffix_index index;
+    if (!suffix_index_open(&index, path)) {
+        fprintf(stderr, "Could not read the index %s\n", path);
+        return 2;
+    }
+
+    FILE *file = fopen(output, "w");
+    int result = 0;
+    bool damaged = false;
+    if (file == NULL) {
+        result = 3;
+    } else {
+        for (size_t i = 0; i < patterns->count && !damaged; i++) {
+            size_t count = suffix_index_count(&index, patterns->items[i]);
+            damaged = count == INDEX_DAMAGED;
+            if (!damaged) {
+                write_number(file, (long) count);
+                fputc('\n', file);
+            }
+        }
+        result = fclose(file) == EOF ? 3 : 0;
+    }
+    if (damaged) {
+        // incomplete output is not left behind
+        unlink(output);
+        fprintf(stderr, "Could not read the index %s (it is damaged)\n", path);
+        result = 2;
+    } else if (result != 0) {
+        fprintf(stderr, "Could not write the output file %s\n", output);
+    }
+
+    suffix_index_close(&index);
+    return result;
+}
+
+/**
+ * @brief Main function of a program.
+ * @returns Exit code that denotes following:
+ *      0 in case of success
+ *      1 in case of invalid usage
+ *      2 in case of failure on input file (or index when querying)
+ *      3 in case of failure on output file (or index when building)
+ */
+int main(int argc, char **argv)
+{
+    bool building = false;
+    const char *pattern_file = NULL;
+    bool valid = true;
+
+    int option;
+    while ((option = getopt(argc, argv, "bp:")) != -1) {
+        switch (option) {
+        case 'b':
+            building = true;
+            break;
+        case 'p':
+            pattern_file = optarg;
+            break;
+        default:
+            valid = false;
+            break;
+        }
+    }
+
+    int first = optind;
+    if (!valid || argc - first < 2 || (building && argc - first != 2)) {
+        printf("Usage: %s -b <input-file> <index-file>\n", argv[0]);
+        printf("       %s [-p pattern-file] <index-file> <output-file> [string-to-be-counted...]\n", argv[0]);
+        printf("  -b  build the index of the input file, it takes 5 bytes per byte of the file\n");
+        printf("  -p  file with more strings to be counted, one per line\n");
+        printf("Index holds the sorted suffixes of the file, so each string is counted by\n");
+        printf("a binary search without reading the input file again. Count of each string\n");
+        printf("is written on a separate line in the order they are given.\n");
+        return 1;
+    }
+    if (building) {
+        return build(argv[first], argv[first + 1]);
+    }
+
+    struct pattern_list patterns = { 0, 0, NULL };
+    bool loaded = true;
+    for (int i = first + 2; loaded && i < argc; i++) {
+        loaded = patterns_add(&patterns, argv[i], strlen(argv[i]));
+    }
+    if (loaded && pattern_file != NULL && !patterns_load(&patterns, pattern_file)) {
+        fprintf(stderr, "Could not load the strings from %s\n", pattern_file);
+        patterns_free(&patterns);
+        return 1;
+    }
+    if (loaded && patterns.count == 0) {
+        loaded = patterns_add(&patterns, "ananas", strlen("ananas"));
+    }
+    if (!loaded) {
+        fprintf(stderr, "Could not allocate the strings\n");
+        patterns_free(&patterns);
+        return 2;
+    }
+
+    int result = query(argv[first], &patterns, argv[first + 1]);
+    patterns_free(&patterns);
+    return result;
+}
@@ -0,0 +1,370 @@
+#include "decoder.h"
+
+#include <errno.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <zlib.h>
+
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+/**
+ * @brief Result of one step of the decompression.
+ */
+enum step_t
+{
+    STEP_ERROR,
+    STEP_OK,
+    /** Member or frame has been finished, another one may follow. */
+    STEP_END,
+};
+
+enum compression_t compression_detect(const unsigned char *header, size_t length)
+{
+    // magic number is followed by the method, only deflate (8) is defined
+    static const unsigned char gzip[] = { 0x1f, 0x8b, 0x08 };
+    static const unsigned char zstd[] = { 0x28, 0xb5, 0x2f, 0xfd };
+
+    if (length >= sizeof(gzip) && memcmp(header, gzip, sizeof(gzip)) == 0) {
+        return COMPRESSION_GZIP;
+    }
+    if (length >= sizeof(zstd) && memcmp(header, zstd, sizeof(zstd)) == 0) {
+        return COMPRESSION_ZSTD;
+    }
+    return COMPRESSION_NONE;
+}
+
+bool compression_supported(enum compression_t format)
+{
+    switch (format) {
+    case COMPRESSION_NONE:
+    case COMPRESSION_GZIP:
+        return true;
+    case COMPRESSION_ZSTD:
+#ifdef HAVE_ZSTD
+        return true;
+#else
+        return false;
+#endif
+    }
+    return false;
+}
+
+const char *compression_name(enum compression_t format)
+{
+    switch (format) {
+    case COMPRESSION_GZIP:
+        return "gzip";
+    case COMPRESSION_ZSTD:
+        return "zstd";
+    default:
+        return "plain";
+    }
+}
+
+/**
+ * @brief Reads as many bytes as possible, unless the end of the file is
+ * reached.
+ * @param fd Descriptor of the file.
+ * @param block Buffer for the bytes.
+ * @param size Size of the buffer.
+ * @param error Output parameter for <code>errno</code> of the failed read.
+ * @returns Count of the bytes read.
+ */
+static size_t read_block(int fd, unsigned char *block, size_t size, int *error)
+{
+    size_t total = 0;
+    while (total < size) {
+        ssize_t count = read(fd, block + total, size - total);
+        if (count == 0) {
+            break;
+        }
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            *error = errno;
+            break;
+        }
+        total += (size_t) count;
+    }
+    return total;
+}
+
+/**
+ * @brief Refills the input buffer once it has been consumed.
+ * @param decoder Decoder of the file.
+ * @param error Output parameter for <code>errno</code> of the failed read.
+ * @returns <code>true</code> if there are new data, <code>false</code> at the
+ * end of the file or in case of failure.
+ */
+static bool fill(struct decoder *decoder, int *error)
+{
+    if (decoder->eof) {
+        return false;
+    }
+
+    decoder->rewindable = false;
+    decoder->start = 0;
+    decoder->end = 0;
+    for (;;) {
+        ssize_t count = read(decoder->fd, decoder->input, DECODER_INPUT_SIZE);
+        if (count > 0) {
+            decoder->end = (size_t) count;
+            return true;
+        }
+        if (count == 0) {
+            decoder->eof = true;
+            return false;
+        }
+        if (errno != EINTR) {
+            *error = errno;
+            return false;
+        }
+    }
+}
+
+/**
+ * @brief Passes the file through, bytes read while recognizing the format go
+ * first.
+ */
+static size_t read_plain(struct decoder *decoder, unsigned char *block, size_t size, int *error)
+{
+    size_t buffered = decoder->end - decoder->start;
+    if (buffered > size) {
+        buffered = size;
+    }
+    memcpy(block, decoder->input + decoder->start, buffered);
+    decoder->start += buffered;
+    return buffered + read_block(decoder->fd, block + buffered, size - buffered, error);
+}
+
+/**
+ * @brief State of zlib and the header of the first member, so that it is known
+ * whether inflate has rejected the header or the compressed data.
+ */
+struct gzip_stream
+{
+    z_stream stream;
+    gz_header header;
+};
+
+static bool init_gzip(struct decoder *decoder)
+{
+    struct gzip_stream *gzip = calloc(1, sizeof(struct gzip_stream));
+    // 16 is added to the window bits to accept the gzip header only
+    if (gzip == NULL || inflateInit2(&gzip->stream, 16 + MAX_WBITS) != Z_OK) {
+        free(gzip);
+        return false;
+    }
+    inflateGetHeader(&gzip->stream, &gzip->header);
+    decoder->stream = gzip;
+    return true;
+}
+
+static enum step_t step_gzip(struct decoder *decoder, unsigned char *block, size_t size, size_t *produced)
+{
+    z_stream *stream = &((struct gzip_stream *) decoder->stream)->stream;
+    uInt available = size - *produced > UINT_MAX ? UINT_MAX : (uInt) (size - *produced);
+    stream->next_in = decoder->input + decoder->start;
+    stream->avail_in = (uInt) (decoder->end - decoder->start);
+    stream->next_out = block + *produced;
+    stream->avail_out = available;
+
+    int status = inflate(stream, Z_NO_FLUSH);
+    decoder->start = decoder->end - stream->avail_in;
+    *produced += available - stream->avail_out;
+
+    if (status == Z_STREAM_END) {
+        // concatenated members are decompressed as a single file, like gzip -d does
+        return inflateReset(stream) == Z_OK ? STEP_END : STEP_ERROR;
+    }
+    return status == Z_OK || status == Z_BUF_ERROR ? STEP_OK : STEP_ERROR;
+}
+
+#ifdef HAVE_ZSTD
+
+static bool init_zstd(struct decoder *decoder)
+{
+    ZSTD_DStream *stream = ZSTD_createDStream();
+    if (stream == NULL || ZSTD_isError(ZSTD_initDStream(stream))) {
+        ZSTD_freeDStream(stream);
+        return false;
+    }
+    decoder->stream = stream;
+    return true;
+}
+
+static enum step_t step_zstd(struct decoder *decoder, unsigned char *block, size_t size, size_t *produced)
+{
+    ZSTD_inBuffer in = { decoder->input, decoder->end, decoder->start };
+    ZSTD_outBuffer out = { block, size, *produced };
+
+    size_t hint = ZSTD_decompressStream(decoder->stream, &out, &in);
+    decoder->start = in.pos;
+    *produced = out.pos;
+
+    if (ZSTD_isError(hint)) {
+        return STEP_ERROR;
+    }
+    // next frame is started by the following call on its own
+    return hint == 0 ? STEP_END : STEP_OK;
+}
+
+#endif
+
+bool decoder_init(struct decoder *decoder, int fd)
+{
+    decoder->fd = fd;
+    decoder->format = COMPRESSION_NONE;
+    decoder->stream = NULL;
+    decoder->start = 0;
+    decoder->end = 0;
+    decoder->eof = false;
+    decoder->boundary = false;
+    decoder->finished = false;
+    decoder->rewindable = true;
+
+    decoder->input = malloc(DECODER_INPUT_SIZE);
+    if (decoder->input == NULL) {
+        return false;
+    }
+
+    // pipes may return less than the header at once
+    int error = 0;
+    decoder->end = read_block(fd, decoder->input, DECODER_HEADER, &error);
+    decoder->format = compression_detect(decoder->input, decoder->end);
+
+    bool started = error == 0 && compression_supported(decoder->format);
+    if (started && decoder->format == COMPRESSION_GZIP) {
+        // whole buffer is filled, so that the start of the file is kept in
+        // case the header is rejected
+        decoder->end += read_block(fd, decoder->input + decoder->end, DECODER_INPUT_SIZE - decoder->end, &error);
+        decoder->eof = decoder->end < DECODER_INPUT_SIZE;
+        started = error == 0 && init_gzip(decoder);
+    }
+#ifdef HAVE_ZSTD
+    if (started && decoder->format == COMPRESSION_ZSTD) {
+        started = init_zstd(decoder);
+    }
+#endif
+
+    if (!started) {
+        free(decoder->input);
+        decoder->input = NULL;
+        if (error != 0) {
+            errno = error;
+        }
+    }
+    return started;
+}
+
+/**
+ * @brief Passes the file through if inflate has rejected the header of the
+ * first member (e.g. with reserved flags set) or the file ends within it, such
+ * a file only starts like gzip by chance.
+ * @param decoder Decoder of the file.
+ * @returns <code>true</code> if the file is passed through from now on,
+ * <code>false</code> if the header has been accepted or the start of the
+ * file is not in the buffer anymore.
+ */
+static bool fall_back(struct decoder *decoder)
+{
+    struct gzip_stream *gzip = decoder->stream;
+    if (decoder->format != COMPRESSION_GZIP || !decoder->rewindable || gzip->header.done != 0) {
+        return false;
+    }
+
+    inflateEnd(&gzip->stream);
+    free(gzip);
+    decoder->stream = NULL;
+    decoder->format = COMPRESSION_NONE;
+    decoder->start = 0;
+    return true;
+}
+
+/**
+ * @brief Runs one step of the decompression in the format of the file.
+ */
+static enum step_t step(struct decoder *decoder, unsigned char *block, size_t size, size_t *produced)
+{
+    switch (decoder->format) {
+    case COMPRESSION_GZIP:
+        return step_gzip(decoder, block, size, produced);
+#ifdef HAVE_ZSTD
+    case COMPRESSION_ZSTD:
+        return step_zstd(decoder, block, size, produced);
+#endif
+    default:
+        (void) decoder;
+        (void) block;
+        (void) size;
+        (void) produced;
+        return STEP_ERROR;
+    }
+}
+
+size_t decoder_read(struct decoder *decoder, unsigned char *block, size_t size, int *error)
+{
+    if (decoder->format == COMPRESSION_NONE) {
+        return read_plain(decoder, block, size, error);
+    }
+
+    size_t produced = 0;
+    while (produced < size && !decoder->finished) {
+        size_t consumed = decoder->start;
+        size_t before = produced;
+        enum step_t result = step(decoder, block, size, &produced);
+        if (result == STEP_ERROR) {
+            if (fall_back(decoder)) {
+                return read_plain(decoder, block, size, error);
+            }
+            *error = EIO;
+            break;
+        }
+
+        // a call without any progress after the end of the member (e.g. with
+        // no input) does not start another one
+        if (result == STEP_END) {
+            decoder->boundary = true;
+        } else if (decoder->start != consumed || produced != before) {
+            decoder->boundary = false;
+        }
+
+        // output is flushed as far as possible unless the block is full, so
+        // more input is needed
+        if (produced < size && decoder->start == decoder->end && !fill(decoder, error)) {
+            if (*error == 0 && !decoder->boundary) {
+                if (fall_back(decoder)) {
+                    return read_plain(decoder, block, size, error);
+                }
+                // file ends in the middle of the member
+                *error = EIO;
+            }
+            decoder->finished = *error == 0;
+            break;
+        }
+    }
+    return produced;
+}
+
+void decoder_destroy(struct decoder *decoder)
+{
+    if (decoder->format == COMPRESSION_GZIP && decoder->stream != NULL) {
+        struct gzip_stream *gzip = decoder->stream;
+        inflateEnd(&gzip->stream);
+        free(gzip);
+    }
+#ifdef HAVE_ZSTD
+    if (decoder->format == COMPRESSION_ZSTD) {
+        ZSTD_freeDStream(decoder->stream);
+    }
+#endif
+    free(decoder->input);
+    decoder->input = NULL;
+    decoder->stream = NULL;
+}
@@ -0,0 +1,110 @@
+#ifndef _DECODER_H
+#define _DECODER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * Count of the bytes at the start of the file that are needed to recognize
+ * the compression.
+ */
+#define DECODER_HEADER 4
+
+/**
+ * Size of the buffer for the compressed data.
+ */
+#define DECODER_INPUT_SIZE ((size_t) 128 << 10)
+
+/**
+ * @brief Format of the file.
+ */
+enum compression_t
+{
+    COMPRESSION_NONE,
+    /** One or more gzip members. Files whose header is rejected by zlib are
+     * passed through. */
+    COMPRESSION_GZIP,
+    /** One or more zstd frames, needs libzstd (<code>HAVE_ZSTD</code>). */
+    COMPRESSION_ZSTD,
+};
+
+/**
+ * @brief Decompresses the file on the fly, block by block; the whole plain
+ * text is never held in the memory.
+ */
+struct decoder
+{
+    int fd;
+    enum compression_t format;
+    /** State of zlib or libzstd. */
+    void *stream;
+
+    unsigned char *input;
+    /** Compressed data in the input buffer that have not been consumed yet. */
+    size_t start;
+    size_t end;
+    /** Whether the end of the file has been reached. */
+    bool eof;
+    /** Whether the last member or frame has been finished. */
+    bool boundary;
+    bool finished;
+    /** Whether the input buffer still holds the start of the file. */
+    bool rewindable;
+};
+
+/**
+ * @brief Recognizes the compression by the magic number at the start of the
+ * file.
+ * @param header Start of the file.
+ * @param length Length of the header, at most <code>DECODER_HEADER</code>
+ * bytes are checked.
+ * @returns Format of the file.
+ */
+enum compression_t compression_detect(const unsigned char *header, size_t length);
+
+/**
+ * @brief Checks whether the format can be decompressed by this build.
+ * @param format Format of the file.
+ * @returns <code>true</code> if it is supported, <code>false</code> otherwise.
+ */
+bool compression_supported(enum compression_t format);
+
+/**
+ * @brief Gets the name of the format.
+ * @param format Format of the file.
+ * @returns Name of the format, e.g. <code>gzip</code>.
+ */
+const char *compression_name(enum compression_t format);
+
+/**
+ * @brief Reads the start of the file and recognizes its format, the file does
+ * not need to be seekable (e.g. a pipe). Files that are not compressed are
+ * passed through.
+ * @param decoder Decoder to be initialized.
+ * @param fd Descriptor of the file, it is not closed by the decoder.
+ * @returns <code>true</code> if the decoder has been initialized, <code>false
+ * </code> if the file could not be read, its compression is not supported
+ * (<code>format</code> is set even then) or the memory could not be
+ * allocated.
+ */
+bool decoder_init(struct decoder *decoder, int fd);
+
+/**
+ * @brief Reads the next block of the plain text.
+ * @param decoder Decoder of the file.
+ * @param block Buffer for the block.
+ * @param size Size of the block, the whole block is filled unless the end of
+ * the file is reached.
+ * @param error Output parameter for <code>errno</code> in case the file could
+ * not be read, <code>EIO</code> if it is corrupted or truncated.
+ * @returns Count of the bytes in the block, 0 at the end of the file.
+ */
+size_t decoder_read(struct decoder *decoder, unsigned char *block, size_t size, int *error);
+
+/**
+ * @brief Frees the memory held by the decoder.
+ * @param decoder Decoder to be destroyed.
+ */
+void decoder_destroy(struct decoder *decoder);
+
+#endif
@@ -0,0 +1,54 @@
+#include "dfa.h"
+
+#include <ctype.h>
+#include <string.h>
+
+bool dfa_compile(struct dfa *dfa, const char *substring)
+{
+    size_t length = strlen(substring);
+    if (length == 0 || length > DFA_MAX_PATTERN) {
+        return false;
+    }
+    dfa->length = (unsigned) length;
+
+    unsigned char pattern[DFA_MAX_PATTERN];
+    for (size_t i = 0; i < length; i++) {
+        pattern[i] = (unsigned char) tolower((unsigned char) substring[i]);
+    }
+
+    // state that the automaton would be in after reading the current prefix
+    // without its first byte, i.e. where the failure link leads
+    unsigned restart = 0;
+    for (unsigned state = 0; state <= length; state++) {
+        for (int byte = 0; byte < 256; byte++) {
+            unsigned folded = (unsigned) tolower(byte);
+            if (state < length && folded == pattern[state]) {
+                dfa->next[state][byte] = (unsigned char) (state + 1);
+            } else {
+                dfa->next[state][byte] = state == 0 ? 0 : dfa->next[restart][byte];
+            }
+        }
+
+        if (state > 0 && state < length) {
+            restart = dfa->next[restart][pattern[state]];
+        }
+    }
+    return true;
+}
+
+size_t dfa_count(const struct dfa *dfa, unsigned *state, const unsigned char *data, size_t length)
+{
+    // locals, since the data could alias the automaton otherwise
+    const unsigned char(*next)[256] = dfa->next;
+    unsigned accepting = dfa->length;
+    unsigned current = *state;
+    size_t count = 0;
+
+    for (size_t i = 0; i < length; i++) {
+        current = next[current][data[i]];
+        count += current == accepting;
+    }
+
+    *state = current;
+    return count;
+}
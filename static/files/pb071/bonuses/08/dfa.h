@@ -0,0 +1,52 @@
+#ifndef _DFA_H
+#define _DFA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * Longest substring that can be compiled into the automaton.
+ */
+#define DFA_MAX_PATTERN 64
+
+/**
+ * @brief Deterministic automaton that recognizes the substring (KMP automaton
+ * with the failure links resolved for every byte).
+ *
+ * State is the length of the longest prefix of the substring that the data
+ * read so far end with, each byte moves the automaton by one lookup into the
+ * table, so the data are read exactly once without any backtracking, no
+ * matter how much the substring overlaps with itself. Automaton has a fixed
+ * size and needs no allocation, it can be kept on the stack.
+ */
+struct dfa
+{
+    /** Length of the substring, i.e. the accepting state. */
+    unsigned length;
+    /** Next state for each state and byte, letters of both cases lead to the same state. */
+    unsigned char next[DFA_MAX_PATTERN + 1][256];
+};
+
+/**
+ * @brief Compiles the substring into the automaton.
+ * @param dfa Automaton to be initialized.
+ * @param substring Substring to be recognized, letters are compared without
+ * regard to their case.
+ * @returns <code>true</code> if the automaton has been compiled, <code>false
+ * </code> if the substring is empty or longer than <code>DFA_MAX_PATTERN</code>.
+ */
+bool dfa_compile(struct dfa *dfa, const char *substring);
+
+/**
+ * @brief Counts occurences of the substring in the data, including the
+ * overlapping ones. Data can be passed in any number of blocks, the state
+ * is carried over, so the occurences that straddle the blocks are counted too.
+ * @param dfa Compiled automaton.
+ * @param state State of the automaton, 0 before the first block; updated.
+ * @param data Block of the data.
+ * @param length Length of the block.
+ * @returns Count of the occurences that end within the block.
+ */
+size_t dfa_count(const struct dfa *dfa, unsigned *state, const unsigned char *data, size_t length);
+
+#endif
@@ -0,0 +1,154 @@
+#include "files.h"
+
+#include <dirent.h>
+#include <glob.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+void files_init(struct file_list *list)
+{
+    list->count = 0;
+    list->capacity = 0;
+    list->files = NULL;
+}
+
+/**
+ * @brief Appends the copy of the path to the list.
+ * @param list List of the files.
+ * @param path Path to the file.
+ * @param size Size of the file.
+ * @returns <code>true</code> if the path has been appended, <code>false</code>
+ * if the memory could not be allocated.
+ */
+static bool append(struct file_list *list, const char *path, size_t size)
+{
+    if (list->count == list->capacity) {
+        size_t capacity = list->capacity == 0 ? 16 : 2 * list->capacity;
+        struct file_entry *files = realloc(list->files, capacity * sizeof(struct file_entry));
+        if (files == NULL) {
+            return false;
+        }
+        list->files = files;
+        list->capacity = capacity;
+    }
+
+    char *copy = malloc(strlen(path) + 1);
+    if (copy == NULL) {
+        return false;
+    }
+    strcpy(copy, path);
+    list->files[list->count].path = copy;
+    list->files[list->count].size = size;
+    list->count++;
+    return true;
+}
+
+static bool collect(struct file_list *list, const char *path, bool top);
+
+/**
+ * @brief Appends the regular files from the directory and its subdirectories.
+ * @param list List of the files.
+ * @param path Path to the directory.
+ * @returns <code>true</code> if the whole directory has been read, <code>false
+ * </code> otherwise.
+ */
+static bool collect_directory(struct file_list *list, const char *path)
+{
+    DIR *directory = opendir(path);
+    if (directory == NULL) {
+        return false;
+    }
+
+    size_t length = strlen(path);
+    bool separator = length > 0 && path[length - 1] != '/';
+    bool collected = true;
+    struct dirent *entry;
+    while (collected && (entry = readdir(directory)) != NULL) {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
+            continue;
+        }
+
+        char *child = malloc(length + strlen(entry->d_name) + 2);
+        if (child == NULL) {
+            collected = false;
+            break;
+        }
+        strcpy(child, path);
+        strcpy(child + length, separator ? "/" : "");
+        strcat(child, entry->d_name);
+
+        collected = collect(list, child, false);
+        free(child);
+    }
+
+    closedir(directory);
+    return collected;
+}
+
+/**
+ * @brief Appends the file or the files from the directory.
+ * @param list List of the files.
+ * @param path Path to the file or the directory.
+ * @param top Whether the path has been given by the user, symbolic links
+ * to directories are followed only then.
+ * @returns <code>true</code> if the files have been appended, <code>false
+ * </code> otherwise.
+ */
+static bool collect(struct file_list *list, const char *path, bool top)
+{
+    struct stat info;
+    if ((top ? stat(path, &info) : lstat(path, &info)) != 0) {
+        return false;
+    }
+
+    if (S_ISLNK(info.st_mode)) {
+        // link to a regular file is counted, other links are skipped
+        return stat(path, &info) != 0 || !S_ISREG(info.st_mode) || append(list, path, (size_t) info.st_size);
+    }
+    if (S_ISDIR(info.st_mode)) {
+        return collect_directory(list, path);
+    }
+    if (S_ISREG(info.st_mode)) {
+        return append(list, path, (size_t) info.st_size);
+    }
+
+    // devices, pipes and sockets found in the directories are skipped
+    return !top;
+}
+
+static int compare_paths(const void *first, const void *second)
+{
+    return strcmp(((const struct file_entry *) first)->path, ((const struct file_entry *) second)->path);
+}
+
+bool files_collect(struct file_list *list, const char *path)
+{
+    struct stat info;
+    bool collected;
+
+    if (stat(path, &info) == 0) {
+        collected = collect(list, path, true);
+    } else {
+        glob_t matches;
+        collected = glob(path, 0, NULL, &matches) == 0;
+        for (size_t i = 0; collected && i < matches.gl_pathc; i++) {
+            collected = collect(list, matches.gl_pathv[i], true);
+        }
+        globfree(&matches);
+    }
+
+    if (list->count > 0) {
+        qsort(list->files, list->count, sizeof(struct file_entry), compare_paths);
+    }
+    return collected;
+}
+
+void files_destroy(struct file_list *list)
+{
+    for (size_t i = 0; i < list->count; i++) {
+        free(list->files[i].path);
+    }
+    free(list->files);
+    files_init(list);
+}
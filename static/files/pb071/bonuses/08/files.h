@@ -0,0 +1,53 @@
+#ifndef _FILES_H
+#define _FILES_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @brief Regular file that has been found.
+ */
+struct file_entry
+{
+    char *path;
+    /** Size of the file at the time it has been found. */
+    size_t size;
+};
+
+/**
+ * @brief Regular files that are counted at once, sorted by their paths.
+ */
+struct file_list
+{
+    size_t count;
+    size_t capacity;
+    struct file_entry *files;
+};
+
+/**
+ * @brief Initializes an empty list.
+ * @param list List to be initialized.
+ */
+void files_init(struct file_list *list);
+
+/**
+ * @brief Appends the regular files given by the path to the list. Directory
+ * is searched recursively (symbolic links to directories are not followed,
+ * so there are no cycles), path that does not exist is expanded as a glob
+ * pattern, e.g. <code>logs/2023-*.txt</code>. Files are sorted by their paths
+ * afterwards.
+ * @param list List of the files.
+ * @param path Path to the file or the directory, or the pattern.
+ * @returns <code>true</code> if all the files have been found, <code>false
+ * </code> if some directory could not be read, the pattern matches nothing
+ * or the memory could not be allocated.
+ */
+bool files_collect(struct file_list *list, const char *path);
+
+/**
+ * @brief Frees the memory held by the list.
+ * @param list List to be destroyed.
+ */
+void files_destroy(struct file_list *list);
+
+#endif
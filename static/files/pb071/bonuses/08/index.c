@@ -0,0 +1,220 @@
+#include "index.h"
+#include "mapped.h"
+#include "sais.h"
+
+#include <ctype.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define INDEX_MAGIC "SAINDEX1"
+
+/**
+ * @brief Header at the start of the index file.
+ */
+struct index_header
+{
+    char magic[8];
+    uint64_t length;
+};
+
+/**
+ * @brief Computes the size of the index file.
+ * @param length Length of the text.
+ * @returns Size in bytes.
+ */
+static size_t index_size(size_t length)
+{
+    return sizeof(struct index_header) + ((length + 3) & ~(size_t) 3) + length * sizeof(uint32_t);
+}
+
+/**
+ * @brief Sets the parts of the index to their places in the mapping.
+ * @param index Index whose mapping and length are set.
+ */
+static void locate(struct suffix_index *index)
+{
+    unsigned char *start = index->mapping;
+    index->text = start + sizeof(struct index_header);
+    index->suffixes = (const uint32_t *) (index->text + ((index->length + 3) & ~(size_t) 3));
+}
+
+/**
+ * @brief Fills in the text of the index, letters are converted to lowercase.
+ * @param fd Descriptor of the original file.
+ * @param text Text of the index.
+ * @param length Length of the file.
+ * @returns <code>true</code> if the file has been read, <code>false</code>
+ * otherwise.
+ */
+static bool copy_text(int fd, unsigned char *text, size_t length)
+{
+    if (length == 0) {
+        return true;
+    }
+
+    struct mapped_file file;
+    if (!mapped_file_open(&file, fd) || file.length != length) {
+        return false;
+    }
+    for (size_t i = 0; i < length; i++) {
+        text[i] = (unsigned char) tolower(file.data[i]);
+    }
+    mapped_file_close(&file);
+    return true;
+}
+
+bool suffix_index_build(int fd, const char *path)
+{
+    struct stat info;
+    if (fstat(fd, &info) == -1 || !S_ISREG(info.st_mode) || (uint64_t) info.st_size > SUFFIX_ARRAY_MAX_LENGTH) {
+        return false;
+    }
+
+    struct suffix_index index = { NULL, NULL, (size_t) info.st_size, NULL, index_size((size_t) info.st_size) };
+    int output = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (output == -1) {
+        return false;
+    }
+    if (ftruncate(output, (off_t) index.size) == -1) {
+        close(output);
+        unlink(path);
+        return false;
+    }
+    index.mapping = mmap(NULL, index.size, PROT_READ | PROT_WRITE, MAP_SHARED, output, 0);
+    close(output);
+    if (index.mapping == MAP_FAILED) {
+        unlink(path);
+        return false;
+    }
+
+    locate(&index);
+    unsigned char *text = (unsigned char *) index.text;
+    bool built = copy_text(fd, text, index.length) && suffix_array(text, (uint32_t *) index.suffixes, index.length);
+
+    // header is written last, so that an unfinished index is never valid
+    if (built) {
+        struct index_header *header = index.mapping;
+        header->length = index.length;
+        memcpy(header->magic, INDEX_MAGIC, sizeof(header->magic));
+    }
+    munmap(index.mapping, index.size);
+    if (!built) {
+        unlink(path);
+    }
+    return built;
+}
+
+bool suffix_index_open(struct suffix_index *index, const char *path)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd == -1) {
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) == -1 || (size_t) info.st_size < sizeof(struct index_header)) {
+        close(fd);
+        return false;
+    }
+    index->size = (size_t) info.st_size;
+    index->mapping = mmap(NULL, index->size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (index->mapping == MAP_FAILED) {
+        return false;
+    }
+
+    const struct index_header *header = index->mapping;
+    index->length = (size_t) header->length;
+    if (memcmp(header->magic, INDEX_MAGIC, sizeof(header->magic)) != 0 || header->length > SUFFIX_ARRAY_MAX_LENGTH || index_size(index->length) != index->size) {
+        munmap(index->mapping, index->size);
+        return false;
+    }
+
+    locate(index);
+
+    // binary search jumps all over the array, reading ahead is useless
+    madvise(index->mapping, index->size, MADV_RANDOM);
+    return true;
+}
+
+/**
+ * @brief Compares the suffix with the substring, only the prefix of the suffix
+ * of the same length as the substring is taken into account.
+ * @param index Mapped index.
+ * @param suffix Start of the suffix.
+ * @param substring Substring (any case).
+ * @param length Length of the substring.
+ * @returns Negative number if the suffix is smaller, 0 if the substring is its
+ * prefix, positive number if the suffix is greater.
+ */
+static int compare_prefix(const struct suffix_index *index, uint32_t suffix, const unsigned char *substring, size_t length)
+{
+    const unsigned char *text = index->text + suffix;
+    size_t left = index->length - suffix;
+    for (size_t i = 0; i < length; i++) {
+        if (i == left) {
+            return -1;
+        }
+        int difference = text[i] - tolower(substring[i]);
+        if (difference != 0) {
+            return difference;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Finds the first suffix that is not smaller than the substring (or
+ * that is greater than it, if <code>after</code> is set).
+ * @param low Position in the suffix array where the search starts.
+ * @returns Position of the suffix in the suffix array, <code>INDEX_DAMAGED
+ * </code> if a visited suffix does not start within the text, so that the
+ * search never reads outside of the mapping.
+ */
+static size_t find_bound(const struct suffix_index *index, const unsigned char *substring, size_t length, size_t low, bool after)
+{
+    size_t high = index->length;
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        uint32_t suffix = index->suffixes[middle];
+        if (suffix >= index->length) {
+            return INDEX_DAMAGED;
+        }
+
+        int order = compare_prefix(index, suffix, substring, length);
+        if (order < 0 || (after && order == 0)) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+size_t suffix_index_count(const struct suffix_index *index, const char *substring)
+{
+    size_t length = strlen(substring);
+    if (length == 0) {
+        return 0;
+    }
+
+    const unsigned char *bytes = (const unsigned char *) substring;
+    size_t first = find_bound(index, bytes, length, 0, false);
+    if (first == INDEX_DAMAGED) {
+        return INDEX_DAMAGED;
+    }
+
+    size_t last = find_bound(index, bytes, length, first, true);
+    return last == INDEX_DAMAGED ? INDEX_DAMAGED : last - first;
+}
+
+void suffix_index_close(struct suffix_index *index)
+{
+    munmap(index->mapping, index->size);
+    index->mapping = NULL;
+    index->text = NULL;
+    index->suffixes = NULL;
+}
@@ -0,0 +1,75 @@
+#ifndef _INDEX_H
+#define _INDEX_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Returned by <code>suffix_index_count</code> in case the index is damaged.
+ */
+#define INDEX_DAMAGED ((size_t) -1)
+
+/**
+ * @brief Suffix array of the file that is stored on the disk and mapped into
+ * the memory, so that any count of substrings can be counted without reading
+ * the file again.
+ *
+ * Index file starts with a header (magic and the length of the text), then
+ * follows the text with letters in lowercase (padded to 4 bytes) and the
+ * suffix array of the text as 32-bit numbers in the native byte order. All
+ * occurences of a substring are prefixes of the consecutive suffixes, so they
+ * are counted by two binary searches in O(m log n) and neither of them reads
+ * the original file. Index takes 5 bytes per byte of the file.
+ */
+struct suffix_index
+{
+    /** Text in lowercase. */
+    const unsigned char *text;
+    /** Starts of the suffixes of the text in the lexicographic order. */
+    const uint32_t *suffixes;
+    size_t length;
+
+    void *mapping;
+    size_t size;
+};
+
+/**
+ * @brief Builds the index of the regular file. Index file is mapped into the
+ * memory and the suffix array is sorted in place, so the memory used besides
+ * the page cache is only a bit per byte of the file.
+ * @param fd Descriptor of the file.
+ * @param path Path to the index file, it is overwritten.
+ * @returns <code>true</code> if the index has been written, <code>false</code>
+ * if the file is not a regular one, it is too big (4 GiB) or the index could
+ * not be written.
+ */
+bool suffix_index_build(int fd, const char *path);
+
+/**
+ * @brief Maps the index into the memory, only its header is read.
+ * @param index Index to be initialized.
+ * @param path Path to the index file.
+ * @returns <code>true</code> if the index has been mapped, <code>false</code>
+ * if it could not be read or it is not a valid index.
+ */
+bool suffix_index_open(struct suffix_index *index, const char *path);
+
+/**
+ * @brief Counts occurences of the substring, letters are compared without
+ * regard to their case and overlapping occurences are counted too.
+ * @param index Mapped index.
+ * @param substring Substring to be counted.
+ * @returns Count of the occurences, 0 for an empty substring. Each suffix that
+ * is visited by the search is checked to start within the text, <code>
+ * INDEX_DAMAGED</code> is returned otherwise.
+ */
+size_t suffix_index_count(const struct suffix_index *index, const char *substring);
+
+/**
+ * @brief Unmaps the index.
+ * @param index Index to be unmapped.
+ */
+void suffix_index_close(struct suffix_index *index);
+
+#endif
@@ -0,0 +1,77 @@
+#include "mapped.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * @brief Maps the part of the file, the mapping starts at the page that holds
+ * the first byte of the part.
+ * @param file File to be initialized.
+ * @param fd Descriptor of the file.
+ * @param start Offset of the first byte of the part.
+ * @param end Offset of the first byte after the part, it is within the file.
+ * @returns <code>true</code> if the part has been mapped, <code>false</code>
+ * otherwise.
+ */
+static bool map_range(struct mapped_file *file, int fd, size_t start, size_t end)
+{
+    size_t page = (size_t) sysconf(_SC_PAGESIZE);
+    file->skew = start & (page - 1);
+    file->length = end - start;
+
+    size_t size = file->length + file->skew;
+    void *mapping = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, (off_t) (start - file->skew));
+    if (mapping == MAP_FAILED) {
+        return false;
+    }
+
+    // hints only, failure does not matter
+    madvise(mapping, size, MADV_SEQUENTIAL);
+#ifdef MADV_HUGEPAGE
+    madvise(mapping, size, MADV_HUGEPAGE);
+#endif
+
+    file->data = (const unsigned char *) mapping + file->skew;
+    return true;
+}
+
+bool mapped_file_open(struct mapped_file *file, int fd)
+{
+    struct stat info;
+    if (fstat(fd, &info) == -1 || !S_ISREG(info.st_mode) || info.st_size == 0) {
+        return false;
+    }
+
+    return map_range(file, fd, 0, (size_t) info.st_size);
+}
+
+bool mapped_file_open_range(struct mapped_file *file, int fd, size_t start, size_t end)
+{
+    struct stat info;
+    if (fstat(fd, &info) == -1 || !S_ISREG(info.st_mode)) {
+        return false;
+    }
+
+    // empty part is not mapped at all
+    size_t size = (size_t) info.st_size;
+    if (end > size) {
+        end = size;
+    }
+    if (start >= end) {
+        file->data = NULL;
+        file->length = 0;
+        file->skew = 0;
+        return true;
+    }
+
+    return map_range(file, fd, start, end);
+}
+
+void mapped_file_close(struct mapped_file *file)
+{
+    if (file->data != NULL) {
+        munmap((void *) (file->data - file->skew), file->length + file->skew);
+    }
+    file->data = NULL;
+}
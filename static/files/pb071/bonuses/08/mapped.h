@@ -0,0 +1,51 @@
+#ifndef _MAPPED_H
+#define _MAPPED_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @brief Regular file (or its part) that is mapped into the memory.
+ *
+ * Data are searched in place, no copies between the kernel and the process
+ * are needed and pages are read ahead by the kernel as the search advances.
+ */
+struct mapped_file
+{
+    const unsigned char *data;
+    size_t length;
+    /** Offset of the data within the mapping, which starts at a page. */
+    size_t skew;
+};
+
+/**
+ * @brief Maps the whole file into the memory.
+ * @param file File to be initialized.
+ * @param fd Descriptor of the file, it can be closed afterwards.
+ * @returns <code>true</code> if the file has been mapped, <code>false</code>
+ * if it is not a regular file, is empty or could not be mapped; the file
+ * needs to be read by <code>read(2)</code> in that case.
+ */
+bool mapped_file_open(struct mapped_file *file, int fd);
+
+/**
+ * @brief Maps only the part of the file, e.g. the chunk that is counted by one
+ * of the threads, so that the rest of the file is not mapped at all.
+ * @param file File to be initialized, its data are the bytes of the file from
+ * <code>start</code> to <code>end</code> (or to the end of the file, in case
+ * it is shorter); the part can be empty.
+ * @param fd Descriptor of the file, it can be closed afterwards.
+ * @param start Offset of the first byte of the part.
+ * @param end Offset of the first byte after the part.
+ * @returns <code>true</code> if the part has been mapped, <code>false</code>
+ * if it is not a regular file or could not be mapped.
+ */
+bool mapped_file_open_range(struct mapped_file *file, int fd, size_t start, size_t end);
+
+/**
+ * @brief Unmaps the file.
+ * @param file File to be unmapped.
+ */
+void mapped_file_close(struct mapped_file *file);
+
+#endif
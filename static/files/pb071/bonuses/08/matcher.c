@@ -0,0 +1,122 @@
+#include "matcher.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+bool matcher_init(struct matcher *matcher, size_t count, const char *const *patterns, bool automaton)
+{
+    matcher->patterns = count;
+
+    if (count != 1) {
+        matcher->kind = MATCH_MULTI;
+        if (!aho_init(&matcher->aho, count, patterns)) {
+            return false;
+        }
+        matcher->longest = matcher->aho.longest;
+        return true;
+    }
+
+    if (!pattern_init(&matcher->pattern, patterns[0])) {
+        return false;
+    }
+    matcher->longest = matcher->pattern.length;
+
+    // empty substring is never found, there is no automaton for it
+    matcher->kind = automaton && matcher->pattern.length > 0 ? MATCH_DFA : MATCH_SEARCH;
+    if (matcher->kind == MATCH_DFA && !dfa_compile(&matcher->dfa, patterns[0])) {
+        pattern_destroy(&matcher->pattern);
+        return false;
+    }
+    return true;
+}
+
+void matcher_destroy(struct matcher *matcher)
+{
+    if (matcher->kind == MATCH_MULTI) {
+        aho_destroy(&matcher->aho);
+    } else {
+        pattern_destroy(&matcher->pattern);
+    }
+}
+
+size_t matcher_margin(const struct matcher *matcher)
+{
+    if (matcher->kind != MATCH_SEARCH || matcher->longest == 0) {
+        return 0;
+    }
+    return matcher->longest - 1;
+}
+
+bool scan_init(const struct matcher *matcher, struct scan *scan)
+{
+    scan->state = 0;
+    scan->multi_state = 0;
+    scan->count = 0;
+    scan->visits = NULL;
+
+    if (matcher->kind == MATCH_MULTI) {
+        scan->visits = calloc(matcher->aho.states, sizeof(size_t));
+        return scan->visits != NULL;
+    }
+    return true;
+}
+
+void scan_block(const struct matcher *matcher, struct scan *scan, const unsigned char *data, size_t length)
+{
+    switch (matcher->kind) {
+    case MATCH_SEARCH:
+        scan->count += pattern_count(&matcher->pattern, data, length);
+        break;
+    case MATCH_DFA:
+        scan->count += dfa_count(&matcher->dfa, &scan->state, data, length);
+        break;
+    case MATCH_MULTI:
+        aho_scan(&matcher->aho, &scan->multi_state, scan->visits, data, length);
+        break;
+    }
+}
+
+void scan_chunk(const struct matcher *matcher, struct scan *scan, const unsigned char *data, size_t length, size_t start, size_t end)
+{
+    size_t overlap = matcher->longest > 0 ? matcher->longest - 1 : 0;
+
+    if (matcher->kind == MATCH_SEARCH) {
+        size_t stop = length - end > overlap ? end + overlap : length;
+        scan_block(matcher, scan, data + start, stop - start);
+        return;
+    }
+
+    // occurences that end within the overlap belong to the previous chunk
+    size_t warm_up = start > overlap ? start - overlap : 0;
+    if (matcher->kind == MATCH_DFA) {
+        dfa_count(&matcher->dfa, &scan->state, data + warm_up, start - warm_up);
+    } else {
+        aho_scan(&matcher->aho, &scan->multi_state, NULL, data + warm_up, start - warm_up);
+    }
+    scan_block(matcher, scan, data + start, end - start);
+}
+
+void scan_merge(const struct matcher *matcher, struct scan *into, const struct scan *from)
+{
+    if (matcher->kind == MATCH_MULTI) {
+        for (size_t i = 0; i < matcher->aho.states; i++) {
+            into->visits[i] += from->visits[i];
+        }
+    } else {
+        into->count += from->count;
+    }
+}
+
+void scan_finish(const struct matcher *matcher, struct scan *scan, size_t *counts)
+{
+    if (counts != NULL) {
+        if (matcher->kind == MATCH_MULTI) {
+            aho_counts(&matcher->aho, scan->visits, counts);
+        } else {
+            counts[0] = scan->count;
+        }
+    }
+
+    free(scan->visits);
+    scan->visits = NULL;
+}
@@ -0,0 +1,132 @@
+#ifndef _MATCHER_H
+#define _MATCHER_H
+
+#include "aho.h"
+#include "dfa.h"
+#include "search.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Way the substrings are counted.
+ */
+enum matcher_kind_t
+{
+    /** Single substring, vectorized search. */
+    MATCH_SEARCH,
+    /** Single substring, automaton that reads each byte once. */
+    MATCH_DFA,
+    /** Any count of substrings at once, Aho-Corasick automaton. */
+    MATCH_MULTI,
+};
+
+/**
+ * @brief Substrings that are counted.
+ */
+struct matcher
+{
+    enum matcher_kind_t kind;
+    /** Count of the substrings. */
+    size_t patterns;
+    /** Length of the longest substring. */
+    size_t longest;
+
+    struct pattern pattern;
+    struct dfa dfa;
+    struct aho_corasick aho;
+};
+
+/**
+ * @brief Progress of the counting in one stream of data, e.g. the file or its
+ * chunk.
+ */
+struct scan
+{
+    unsigned state;
+    uint32_t multi_state;
+    size_t count;
+    size_t *visits;
+};
+
+/**
+ * @brief Prepares the substrings for the counting.
+ * @param matcher Matcher to be initialized.
+ * @param count Count of the substrings, more than one are always counted by
+ * the Aho-Corasick automaton.
+ * @param patterns Substrings to be counted.
+ * @param automaton Whether single substring is to be counted by the automaton
+ * instead of the search.
+ * @returns <code>true</code> if the matcher has been initialized, <code>false
+ * </code> if the memory could not be allocated or the substring is too long
+ * for the automaton.
+ */
+bool matcher_init(struct matcher *matcher, size_t count, const char *const *patterns, bool automaton);
+
+/**
+ * @brief Frees the memory held by the matcher.
+ * @param matcher Matcher to be destroyed.
+ */
+void matcher_destroy(struct matcher *matcher);
+
+/**
+ * @brief Count of the bytes from the end of the previous block that need to
+ * precede the next block, automatons carry their state over instead.
+ * @param matcher Matcher that is used.
+ * @returns Count of the bytes.
+ */
+size_t matcher_margin(const struct matcher *matcher);
+
+/**
+ * @brief Starts the counting.
+ * @param matcher Matcher that is used.
+ * @param scan Progress to be initialized.
+ * @returns <code>true</code> if the counting has been started, <code>false
+ * </code> if the memory could not be allocated.
+ */
+bool scan_init(const struct matcher *matcher, struct scan *scan);
+
+/**
+ * @brief Counts the occurences in the next block of the data.
+ * @param matcher Matcher that is used.
+ * @param scan Progress of the counting.
+ * @param data Block of the data, preceded by the margin in case of the search.
+ * @param length Length of the block.
+ */
+void scan_block(const struct matcher *matcher, struct scan *scan, const unsigned char *data, size_t length);
+
+/**
+ * @brief Counts the occurences in the chunk of the data that is mapped as a
+ * whole, so that chunks can be counted independently (e.g. in parallel) and
+ * each occurence is counted in exactly one of them. Search counts the
+ * occurences that start in the chunk and reads past its end, automatons count
+ * the ones that end in the chunk and are advanced over the bytes before it
+ * without counting first.
+ * @param matcher Matcher that is used.
+ * @param scan Progress of the counting, it is started from the scratch.
+ * @param data Whole data.
+ * @param length Length of the whole data.
+ * @param start Start of the chunk.
+ * @param end End of the chunk.
+ */
+void scan_chunk(const struct matcher *matcher, struct scan *scan, const unsigned char *data, size_t length, size_t start, size_t end);
+
+/**
+ * @brief Adds the counts of another scan, e.g. of another chunk.
+ * @param matcher Matcher that is used.
+ * @param into Progress where the counts are added.
+ * @param from Progress of another scan.
+ */
+void scan_merge(const struct matcher *matcher, struct scan *into, const struct scan *from);
+
+/**
+ * @brief Finishes the counting and frees the memory held by the progress.
+ * @param matcher Matcher that is used.
+ * @param scan Progress of the counting.
+ * @param counts Output array for the count of each substring, or <code>NULL
+ * </code> if the counting is abandoned.
+ */
+void scan_finish(const struct matcher *matcher, struct scan *scan, size_t *counts);
+
+#endif
@@ -0,0 +1,269 @@
+#include "parallel.h"
+#include "mapped.h"
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/**
+ * @brief Picks the size of the chunk, so that there are 4 chunks per thread.
+ * @param pool Pool of the threads.
+ * @param length Length of all the data.
+ * @returns Size of the chunk.
+ */
+static size_t default_chunk_size(const struct thread_pool *pool, size_t length)
+{
+    size_t chunk_size = length / (4 * pool->count) + 1;
+    return chunk_size < PARALLEL_MIN_CHUNK ? PARALLEL_MIN_CHUNK : chunk_size;
+}
+
+enum count_status_t count_stream(int fd, const struct matcher *matcher, size_t block_size, size_t *counts)
+{
+    struct scan scan;
+    struct reader reader;
+    if (!scan_init(matcher, &scan)) {
+        return COUNT_FAILED;
+    }
+    if (!reader_init(&reader, fd, block_size, matcher_margin(matcher))) {
+        scan_finish(matcher, &scan, NULL);
+        return compression_supported(reader.decoder.format) ? COUNT_FAILED : COUNT_UNSUPPORTED;
+    }
+
+    const unsigned char *data;
+    size_t length;
+    while ((length = reader_next(&reader, &data)) != 0 && length != READER_ERROR) {
+        scan_block(matcher, &scan, data, length);
+    }
+
+    reader_destroy(&reader);
+    scan_finish(matcher, &scan, length == 0 ? counts : NULL);
+    return length == 0 ? COUNT_OK : COUNT_FAILED;
+}
+
+/**
+ * @brief Shared state of the parallel counting.
+ */
+struct job
+{
+    const struct matcher *matcher;
+    const unsigned char *data;
+    size_t length;
+    size_t chunk_size;
+
+    pthread_mutex_t lock;
+    struct scan total;
+    bool failed;
+};
+
+static void count_chunk(void *context, size_t index)
+{
+    struct job *job = context;
+    size_t start = index * job->chunk_size;
+    size_t end = job->length - start > job->chunk_size ? start + job->chunk_size : job->length;
+
+    struct scan scan;
+    bool started = scan_init(job->matcher, &scan);
+    if (started) {
+        scan_chunk(job->matcher, &scan, job->data, job->length, start, end);
+    }
+
+    pthread_mutex_lock(&job->lock);
+    if (started) {
+        scan_merge(job->matcher, &job->total, &scan);
+    } else {
+        job->failed = true;
+    }
+    pthread_mutex_unlock(&job->lock);
+
+    scan_finish(job->matcher, &scan, NULL);
+}
+
+bool count_parallel(struct thread_pool *pool, const struct matcher *matcher, const unsigned char *data, size_t length, size_t chunk_size, size_t *counts)
+{
+    if (chunk_size == 0) {
+        chunk_size = default_chunk_size(pool, length);
+    }
+
+    struct job job = { matcher, data, length, chunk_size, PTHREAD_MUTEX_INITIALIZER, { 0, 0, 0, NULL }, false };
+    if (!scan_init(matcher, &job.total)) {
+        return false;
+    }
+
+    thread_pool_run(pool, count_chunk, &job, (length + chunk_size - 1) / chunk_size);
+    pthread_mutex_destroy(&job.lock);
+
+    scan_finish(matcher, &job.total, job.failed ? NULL : counts);
+    return !job.failed;
+}
+
+/**
+ * @brief Chunk of one of the files.
+ */
+struct file_chunk
+{
+    size_t file;
+    size_t start;
+    size_t end;
+};
+
+/**
+ * @brief Shared state of the counting in multiple files.
+ */
+struct files_job
+{
+    const struct matcher *matcher;
+    const struct file_list *files;
+    struct file_chunk *chunks;
+
+    pthread_mutex_t lock;
+    size_t *counts;
+    bool *failed;
+};
+
+/**
+ * @brief Recognizes the compression of the file, so that the files do not
+ * need to be read before they are counted.
+ * @param fd Descriptor of the file.
+ * @param file Part of the file that has been mapped.
+ * @param first Offset of the part, the start of the file is read only in case
+ * it is not mapped with the part.
+ * @returns Format of the file, unreadable start is left for the counting to
+ * report it.
+ */
+static enum compression_t file_compression(int fd, const struct mapped_file *file, size_t first)
+{
+    if (first == 0 && file->length >= DECODER_HEADER) {
+        return compression_detect(file->data, file->length);
+    }
+
+    unsigned char header[DECODER_HEADER];
+    ssize_t length = pread(fd, header, sizeof(header), 0);
+    return length > 0 ? compression_detect(header, (size_t) length) : COMPRESSION_NONE;
+}
+
+/**
+ * @brief Counts the chunk of the file, only the chunk and the bytes around it
+ * that the matcher needs are mapped.
+ * @param matcher Substrings to be counted.
+ * @param entry File to be searched.
+ * @param chunk Chunk of the file.
+ * @param counts Output array for the count of each substring.
+ * @returns <code>true</code> if the chunk has been counted, <code>false
+ * </code> otherwise.
+ */
+static bool count_file_chunk(const struct matcher *matcher, const struct file_entry *entry, const struct file_chunk *chunk, size_t *counts)
+{
+    struct scan scan;
+    if (!scan_init(matcher, &scan)) {
+        return false;
+    }
+
+    // empty files cannot be mapped, there is nothing to be counted anyway
+    if (entry->size == 0) {
+        scan_finish(matcher, &scan, counts);
+        return true;
+    }
+
+    int fd = open(entry->path, O_RDONLY);
+    // search reads past the end of the chunk and automatons are advanced over
+    // the bytes before it (see scan_chunk), file is counted as it has been
+    // found, in case it has changed since
+    size_t overlap = matcher->longest > 0 ? matcher->longest - 1 : 0;
+    size_t first = chunk->start > overlap ? chunk->start - overlap : 0;
+    size_t last = entry->size - chunk->end > overlap ? chunk->end + overlap : entry->size;
+
+    struct mapped_file file;
+    if (fd == -1 || !mapped_file_open_range(&file, fd, first, last)) {
+        if (fd != -1) {
+            close(fd);
+        }
+        scan_finish(matcher, &scan, NULL);
+        return false;
+    }
+
+    // compressed file cannot be split, it is decompressed as a whole by its
+    // first chunk and the other ones count nothing
+    if (file_compression(fd, &file, first) != COMPRESSION_NONE) {
+        mapped_file_close(&file);
+        scan_finish(matcher, &scan, chunk->start == 0 ? NULL : counts);
+        bool counted = chunk->start != 0 || count_stream(fd, matcher, READER_BLOCK_SIZE, counts) == COUNT_OK;
+        close(fd);
+        return counted;
+    }
+    close(fd);
+
+    size_t end = chunk->end - first < file.length ? chunk->end - first : file.length;
+    if (chunk->start - first < end) {
+        scan_chunk(matcher, &scan, file.data, file.length, chunk->start - first, end);
+    }
+
+    mapped_file_close(&file);
+    scan_finish(matcher, &scan, counts);
+    return true;
+}
+
+static void count_files_chunk(void *context, size_t index)
+{
+    struct files_job *job = context;
+    const struct file_chunk *chunk = &job->chunks[index];
+    size_t patterns = job->matcher->patterns;
+
+    size_t *counts = malloc((patterns > 0 ? patterns : 1) * sizeof(size_t));
+    bool counted = counts != NULL && count_file_chunk(job->matcher, &job->files->files[chunk->file], chunk, counts);
+
+    pthread_mutex_lock(&job->lock);
+    if (counted) {
+        for (size_t i = 0; i < patterns; i++) {
+            job->counts[chunk->file * patterns + i] += counts[i];
+        }
+    } else {
+        job->failed[chunk->file] = true;
+    }
+    pthread_mutex_unlock(&job->lock);
+
+    free(counts);
+}
+
+bool count_files(struct thread_pool *pool, const struct matcher *matcher, const struct file_list *files, size_t chunk_size, size_t *counts, bool *failed)
+{
+    size_t total = 0;
+    for (size_t i = 0; i < files->count; i++) {
+        total += files->files[i].size;
+    }
+    if (chunk_size == 0) {
+        chunk_size = default_chunk_size(pool, total);
+    }
+
+    // empty file is a single empty chunk, so that it is opened too
+    size_t chunks = 0;
+    for (size_t i = 0; i < files->count; i++) {
+        size_t size = files->files[i].size;
+        chunks += size == 0 ? 1 : (size + chunk_size - 1) / chunk_size;
+    }
+
+    struct files_job job = { matcher, files, malloc((chunks > 0 ? chunks : 1) * sizeof(struct file_chunk)), PTHREAD_MUTEX_INITIALIZER, counts, failed };
+    if (job.chunks == NULL) {
+        return false;
+    }
+
+    size_t index = 0;
+    for (size_t i = 0; i < files->count; i++) {
+        size_t size = files->files[i].size;
+        size_t start = 0;
+        do {
+            size_t end = size - start > chunk_size ? start + chunk_size : size;
+            job.chunks[index++] = (struct file_chunk) { i, start, end };
+            start = end;
+        } while (start < size);
+    }
+
+    memset(counts, 0, files->count * matcher->patterns * sizeof(size_t));
+    memset(failed, 0, files->count * sizeof(bool));
+    thread_pool_run_stealing(pool, count_files_chunk, &job, chunks);
+
+    pthread_mutex_destroy(&job.lock);
+    free(job.chunks);
+    return true;
+}
@@ -0,0 +1,86 @@
+#ifndef _PARALLEL_H
+#define _PARALLEL_H
+
+#include "files.h"
+#include "matcher.h"
+#include "pool.h"
+#include "reader.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * Least size of the chunk picked by <code>count_parallel</code>.
+ */
+#define PARALLEL_MIN_CHUNK ((size_t) 1 << 20)
+
+/**
+ * @brief Result of counting the whole file.
+ */
+enum count_status_t
+{
+    COUNT_OK,
+    /** File could not be read or the memory could not be allocated. */
+    COUNT_FAILED,
+    /** File is compressed in a format that this build cannot decompress. */
+    COUNT_UNSUPPORTED,
+};
+
+/**
+ * @brief Counts occurences of the substrings in the file, block by block; next
+ * block is read (and decompressed, see <code>decoder.h</code>) by another
+ * thread meanwhile.
+ * @param fd Descriptor of the file.
+ * @param matcher Substrings to be counted.
+ * @param block_size Size of the block.
+ * @param counts Output array for the count of each substring.
+ * @returns <code>COUNT_OK</code> if the whole file has been read, the reason
+ * of the failure otherwise.
+ */
+enum count_status_t count_stream(int fd, const struct matcher *matcher, size_t block_size, size_t *counts);
+
+/**
+ * @brief Counts occurences of the substrings in the data that are mapped as a
+ * whole, chunks of the data are counted by the threads of the pool.
+ *
+ * Occurences that cross the boundary of the chunks are counted in exactly one
+ * of them (see <code>scan_chunk</code>), so the counts are the same as the
+ * ones from the sequential scan. Counts of each chunk are added to the total
+ * right after the chunk is finished, so only the chunks that are being
+ * counted hold their own counters.
+ *
+ * @param pool Pool of the threads.
+ * @param matcher Substrings to be counted.
+ * @param data Data to be searched.
+ * @param length Length of the data.
+ * @param chunk_size Size of the chunk, 0 to split the data into 4 chunks per
+ * thread (at least <code>PARALLEL_MIN_CHUNK</code> bytes each).
+ * @param counts Output array for the count of each substring.
+ * @returns <code>true</code> if the data have been counted, <code>false</code>
+ * if the memory could not be allocated.
+ */
+bool count_parallel(struct thread_pool *pool, const struct matcher *matcher, const unsigned char *data, size_t length, size_t chunk_size, size_t *counts);
+
+/**
+ * @brief Counts occurences of the substrings in each of the files. Files are
+ * split into chunks (small files are a single chunk) that are distributed
+ * among the threads of the pool with the work stealing, so a few big files
+ * are counted by all threads as well as a lot of small ones. Each chunk maps
+ * only its own part of the file (with the bytes around it that the matcher
+ * needs), so only the chunks that are being counted are mapped.
+ * Compression is recognized by the threads as well, compressed file cannot be
+ * split, so it is decompressed and counted as a whole by its first chunk.
+ * @param pool Pool of the threads.
+ * @param matcher Substrings to be counted.
+ * @param files Files to be searched.
+ * @param chunk_size Size of the chunk, 0 to split the data of all files into 4
+ * chunks per thread (at least <code>PARALLEL_MIN_CHUNK</code> bytes each).
+ * @param counts Output array for the counts, a row of <code>matcher->patterns
+ * </code> counts for each file.
+ * @param failed Output array with a flag for each file that could not be read.
+ * @returns <code>true</code> if the files have been counted, <code>false</code>
+ * if the memory could not be allocated.
+ */
+bool count_files(struct thread_pool *pool, const struct matcher *matcher, const struct file_list *files, size_t chunk_size, size_t *counts, bool *failed);
+
+#endif
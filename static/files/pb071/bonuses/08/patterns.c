@@ -0,0 +1,62 @@
+#include "patterns.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+
+bool patterns_add(struct pattern_list *list, const char *substring, size_t length)
+{
+    if (list->count == list->capacity) {
+        size_t capacity = list->capacity == 0 ? 16 : 2 * list->capacity;
+        char **items = realloc(list->items, capacity * sizeof(char *));
+        if (items == NULL) {
+            return false;
+        }
+        list->items = items;
+        list->capacity = capacity;
+    }
+
+    char *copy = malloc(length + 1);
+    if (copy == NULL) {
+        return false;
+    }
+    memcpy(copy, substring, length);
+    copy[length] = '\0';
+    list->items[list->count++] = copy;
+    return true;
+}
+
+bool patterns_load(struct pattern_list *list, const char *path)
+{
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        return false;
+    }
+
+    char *line = NULL;
+    size_t size = 0;
+    ssize_t length;
+    bool loaded = true;
+    while (loaded && (length = getline(&line, &size, file)) != -1) {
+        while (length > 0 && (line[length - 1] == '\n' || line[length - 1] == '\r')) {
+            length--;
+        }
+        if (length > 0) {
+            loaded = patterns_add(list, line, (size_t) length);
+        }
+    }
+
+    loaded = loaded && !ferror(file);
+    free(line);
+    fclose(file);
+    return loaded;
+}
+
+void patterns_free(struct pattern_list *list)
+{
+    for (size_t i = 0; i < list->count; i++) {
+        free(list->items[i]);
+    }
+    free(list->items);
+}
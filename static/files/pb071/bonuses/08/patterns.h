@@ -0,0 +1,43 @@
+#ifndef _PATTERNS_H
+#define _PATTERNS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @brief Substrings given on the command line and in the pattern file.
+ */
+struct pattern_list
+{
+    size_t count;
+    size_t capacity;
+    char **items;
+};
+
+/**
+ * @brief Appends the copy of the substring to the list.
+ * @param list List of the substrings.
+ * @param substring Substring to be appended.
+ * @param length Length of the substring.
+ * @returns <code>true</code> if the substring has been appended, <code>false
+ * </code> if the memory could not be allocated.
+ */
+bool patterns_add(struct pattern_list *list, const char *substring, size_t length);
+
+/**
+ * @brief Appends the substrings from the file, one per line; empty lines are
+ * skipped.
+ * @param list List of the substrings.
+ * @param path Path to the file.
+ * @returns <code>true</code> if the whole file has been loaded, <code>false
+ * </code> otherwise.
+ */
+bool patterns_load(struct pattern_list *list, const char *path);
+
+/**
+ * @brief Frees the substrings.
+ * @param list List of the substrings.
+ */
+void patterns_free(struct pattern_list *list);
+
+#endif
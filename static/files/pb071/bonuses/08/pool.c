@@ -0,0 +1,235 @@
+#include "pool.h"
+
+#include <stdlib.h>
+#include <unistd.h>
+
+/**
+ * @brief Takes the next task from the range.
+ * @param range Range of the tasks.
+ * @param index Output parameter for the index of the task.
+ * @returns <code>true</code> if there has been a task left, <code>false
+ * </code> otherwise.
+ */
+static bool take(struct task_range *range, size_t *index)
+{
+    pthread_mutex_lock(&range->lock);
+    bool taken = range->next < range->end;
+    if (taken) {
+        *index = range->next++;
+    }
+    pthread_mutex_unlock(&range->lock);
+    return taken;
+}
+
+/**
+ * @brief Moves the upper half of the biggest range of the other threads to
+ * the range of the thread.
+ * @param pool Pool of the threads.
+ * @param slot Index of the range of the thread.
+ * @returns <code>true</code> if some tasks have been stolen, <code>false
+ * </code> if there are none left.
+ */
+static bool steal(struct thread_pool *pool, size_t slot)
+{
+    for (;;) {
+        // sizes are only a hint, they are checked again under the lock
+        size_t victim = slot;
+        size_t biggest = 0;
+        for (size_t i = 0; i < pool->count; i++) {
+            struct task_range *range = &pool->ranges[i];
+            pthread_mutex_lock(&range->lock);
+            size_t left = range->end - range->next;
+            pthread_mutex_unlock(&range->lock);
+            if (i != slot && left > biggest) {
+                victim = i;
+                biggest = left;
+            }
+        }
+        if (biggest == 0) {
+            return false;
+        }
+
+        struct task_range *range = &pool->ranges[victim];
+        pthread_mutex_lock(&range->lock);
+        size_t left = range->end - range->next;
+        size_t start = range->next + left / 2;
+        size_t end = range->end;
+        range->end = start;
+        pthread_mutex_unlock(&range->lock);
+
+        if (start < end) {
+            struct task_range *own = &pool->ranges[slot];
+            pthread_mutex_lock(&own->lock);
+            own->next = start;
+            own->end = end;
+            pthread_mutex_unlock(&own->lock);
+            return true;
+        }
+    }
+}
+
+/**
+ * @brief Runs the tasks of the current job until there are none left.
+ */
+static void work(struct thread_pool *pool)
+{
+    size_t index;
+
+    if (!pool->stealing) {
+        while ((index = atomic_fetch_add(&pool->next, 1)) < pool->tasks) {
+            pool->task(pool->context, index);
+        }
+        return;
+    }
+
+    size_t slot = atomic_fetch_add(&pool->joined, 1);
+    do {
+        while (take(&pool->ranges[slot], &index)) {
+            pool->task(pool->context, index);
+        }
+    } while (steal(pool, slot));
+}
+
+static void *worker(void *argument)
+{
+    struct thread_pool *pool = argument;
+    size_t generation = 0;
+
+    pthread_mutex_lock(&pool->lock);
+    for (;;) {
+        while (!pool->stop && pool->generation == generation) {
+            pthread_cond_wait(&pool->wake, &pool->lock);
+        }
+        if (pool->stop) {
+            break;
+        }
+        generation = pool->generation;
+
+        pthread_mutex_unlock(&pool->lock);
+        work(pool);
+        pthread_mutex_lock(&pool->lock);
+
+        pool->idle++;
+        pthread_cond_signal(&pool->finished);
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    return NULL;
+}
+
+bool thread_pool_init(struct thread_pool *pool, size_t threads)
+{
+    if (threads == 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = online > 0 ? (size_t) online : 1;
+    }
+
+    pool->threads = malloc(threads * sizeof(pthread_t));
+    pool->ranges = malloc(threads * sizeof(struct task_range));
+    if (pool->threads == NULL || pool->ranges == NULL) {
+        free(pool->threads);
+        free(pool->ranges);
+        return false;
+    }
+    if (pthread_mutex_init(&pool->lock, NULL) != 0) {
+        free(pool->threads);
+        free(pool->ranges);
+        return false;
+    }
+    for (size_t i = 0; i < threads; i++) {
+        pthread_mutex_init(&pool->ranges[i].lock, NULL);
+        pool->ranges[i].next = pool->ranges[i].end = 0;
+    }
+    pthread_cond_init(&pool->wake, NULL);
+    pthread_cond_init(&pool->finished, NULL);
+
+    pool->task = NULL;
+    pool->context = NULL;
+    pool->tasks = 0;
+    atomic_init(&pool->next, 0);
+    atomic_init(&pool->joined, 0);
+    pool->stealing = false;
+    pool->idle = 0;
+    pool->generation = 0;
+    pool->stop = false;
+
+    // calling thread is the first one of the pool
+    pool->count = 1;
+    while (pool->count < threads && pthread_create(&pool->threads[pool->count], NULL, worker, pool) == 0) {
+        pool->count++;
+    }
+
+    // ranges of the threads that could not be started are never used, so
+    // that only the ones of the running threads are left for the destroy
+    for (size_t i = pool->count; i < threads; i++) {
+        pthread_mutex_destroy(&pool->ranges[i].lock);
+    }
+    return true;
+}
+
+/**
+ * @brief Runs the job on all threads of the pool and waits until it is done.
+ */
+static void run(struct thread_pool *pool, pool_task_t task, void *context, size_t count)
+{
+    pthread_mutex_lock(&pool->lock);
+    pool->task = task;
+    pool->context = context;
+    pool->tasks = count;
+    atomic_store(&pool->next, 0);
+    pool->idle = 0;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+
+    work(pool);
+
+    pthread_mutex_lock(&pool->lock);
+    while (pool->idle < pool->count - 1) {
+        pthread_cond_wait(&pool->finished, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
+
+void thread_pool_run(struct thread_pool *pool, pool_task_t task, void *context, size_t count)
+{
+    pool->stealing = false;
+    run(pool, task, context, count);
+}
+
+void thread_pool_run_stealing(struct thread_pool *pool, pool_task_t task, void *context, size_t count)
+{
+    // workers are idle between the jobs and read the ranges only after they
+    // see the new generation, which run() publishes under the lock after
+    // these writes
+    for (size_t i = 0; i < pool->count; i++) {
+        pool->ranges[i].next = count * i / pool->count;
+        pool->ranges[i].end = count * (i + 1) / pool->count;
+    }
+    atomic_store(&pool->joined, 0);
+    pool->stealing = true;
+    run(pool, task, context, count);
+}
+
+void thread_pool_destroy(struct thread_pool *pool)
+{
+    pthread_mutex_lock(&pool->lock);
+    pool->stop = true;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (size_t i = 1; i < pool->count; i++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+
+    for (size_t i = 0; i < pool->count; i++) {
+        pthread_mutex_destroy(&pool->ranges[i].lock);
+    }
+    pthread_cond_destroy(&pool->finished);
+    pthread_cond_destroy(&pool->wake);
+    pthread_mutex_destroy(&pool->lock);
+    free(pool->threads);
+    free(pool->ranges);
+    pool->threads = NULL;
+    pool->ranges = NULL;
+}
@@ -0,0 +1,144 @@
+#include "reader.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Reads (and decompresses) the blocks into both buffers in turns, until
+ * the end of the file is reached or the reader is stopped.
+ * @param argument Reader of the file.
+ * @returns <code>NULL</code>
+ */
+static void *read_blocks(void *argument)
+{
+    struct reader *reader = argument;
+    int next = 0;
+
+    for (;;) {
+        pthread_mutex_lock(&reader->lock);
+        while (reader->filled == 2 && !reader->stop) {
+            pthread_cond_wait(&reader->changed, &reader->lock);
+        }
+        bool stop = reader->stop;
+        pthread_mutex_unlock(&reader->lock);
+        if (stop) {
+            break;
+        }
+
+        int error = 0;
+        size_t length = decoder_read(&reader->decoder, reader->buffers[next] + reader->margin, reader->block_size, &error);
+
+        pthread_mutex_lock(&reader->lock);
+        reader->lengths[next] = length;
+        reader->error = error;
+        reader->filled++;
+        pthread_cond_broadcast(&reader->changed);
+        pthread_mutex_unlock(&reader->lock);
+
+        if (length == 0 || error != 0) {
+            break;
+        }
+        next ^= 1;
+    }
+
+    return NULL;
+}
+
+bool reader_init(struct reader *reader, int fd, size_t block_size, size_t margin)
+{
+    reader->fd = fd;
+    reader->block_size = block_size != 0 ? block_size : READER_BLOCK_SIZE;
+    reader->margin = margin;
+    reader->current = -1;
+    reader->kept = 0;
+    reader->filled = 0;
+    reader->error = 0;
+    reader->stop = false;
+
+    if (!decoder_init(&reader->decoder, fd)) {
+        return false;
+    }
+    reader->buffers[0] = malloc(margin + reader->block_size);
+    reader->buffers[1] = malloc(margin + reader->block_size);
+    if (reader->buffers[0] == NULL || reader->buffers[1] == NULL) {
+        free(reader->buffers[0]);
+        free(reader->buffers[1]);
+        decoder_destroy(&reader->decoder);
+        return false;
+    }
+
+    pthread_mutex_init(&reader->lock, NULL);
+    pthread_cond_init(&reader->changed, NULL);
+    if (pthread_create(&reader->thread, NULL, read_blocks, reader) != 0) {
+        pthread_cond_destroy(&reader->changed);
+        pthread_mutex_destroy(&reader->lock);
+        free(reader->buffers[0]);
+        free(reader->buffers[1]);
+        decoder_destroy(&reader->decoder);
+        return false;
+    }
+    return true;
+}
+
+size_t reader_next(struct reader *reader, const unsigned char **data)
+{
+    int current = reader->current;
+    if (current != -1 && reader->lengths[current] == 0) {
+        // end of the file has been reached already
+        return 0;
+    }
+    int next = current == -1 ? 0 : current ^ 1;
+
+    // the current buffer is held until its end is copied in front of the next one
+    pthread_mutex_lock(&reader->lock);
+    while (reader->filled < (current == -1 ? 1 : 2)) {
+        pthread_cond_wait(&reader->changed, &reader->lock);
+    }
+    size_t length = reader->lengths[next];
+    int error = reader->error;
+    pthread_mutex_unlock(&reader->lock);
+
+    if (error != 0) {
+        errno = error;
+        return READER_ERROR;
+    }
+
+    size_t keep = 0;
+    if (current != -1) {
+        size_t available = reader->kept + reader->lengths[current];
+        keep = available < reader->margin ? available : reader->margin;
+        memcpy(reader->buffers[next] + reader->margin - keep,
+                reader->buffers[current] + reader->margin + reader->lengths[current] - keep,
+                keep);
+
+        pthread_mutex_lock(&reader->lock);
+        reader->filled--;
+        pthread_cond_broadcast(&reader->changed);
+        pthread_mutex_unlock(&reader->lock);
+    }
+
+    reader->current = next;
+    reader->kept = keep;
+    if (length == 0) {
+        return 0;
+    }
+
+    *data = reader->buffers[next] + reader->margin - keep;
+    return keep + length;
+}
+
+void reader_destroy(struct reader *reader)
+{
+    pthread_mutex_lock(&reader->lock);
+    reader->stop = true;
+    pthread_cond_broadcast(&reader->changed);
+    pthread_mutex_unlock(&reader->lock);
+
+    pthread_join(reader->thread, NULL);
+    pthread_cond_destroy(&reader->changed);
+    pthread_mutex_destroy(&reader->lock);
+    free(reader->buffers[0]);
+    free(reader->buffers[1]);
+    decoder_destroy(&reader->decoder);
+}
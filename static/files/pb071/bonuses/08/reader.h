@@ -0,0 +1,87 @@
+#ifndef _READER_H
+#define _READER_H
+
+#include "decoder.h"
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * Default size of the block that is read at once.
+ */
+#define READER_BLOCK_SIZE ((size_t) 1 << 20)
+
+/**
+ * Returned by <code>reader_next</code> in case of failure.
+ */
+#define READER_ERROR ((size_t) -1)
+
+/**
+ * @brief Reads the file in big blocks by <code>read(2)</code>, compressed files
+ * are decompressed on the fly (see <code>decoder.h</code>).
+ *
+ * There are two buffers, the next block is read (and decompressed) by another
+ * thread into one of them while the current block in the other one is being
+ * scanned, so neither the disk nor the decompression stalls the search. Each buffer
+ * has a margin in front of the block, where the end of the previous block is
+ * copied, so that the matches that straddle the boundary of the blocks can be
+ * found too.
+ */
+struct reader
+{
+    int fd;
+    struct decoder decoder;
+    size_t block_size;
+    /** Count of the bytes that are kept from the previous block. */
+    size_t margin;
+    unsigned char *buffers[2];
+    size_t lengths[2];
+
+    /** Buffer that is being scanned, or -1 before the first block. */
+    int current;
+    /** Count of the bytes from the previous block in front of the current one. */
+    size_t kept;
+
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+    /** Count of the buffers that are read and not released yet. */
+    int filled;
+    /** <code>errno</code> of the failed read, or 0. */
+    int error;
+    bool stop;
+};
+
+/**
+ * @brief Starts reading the file.
+ * @param reader Reader to be initialized.
+ * @param fd Descriptor of the file, it is not closed by the reader.
+ * @param block_size Size of the block, 0 to use <code>READER_BLOCK_SIZE</code>.
+ * @param margin Count of the bytes that precede each block, i.e. length of the
+ * searched substring minus 1.
+ * @returns <code>true</code> if the reader has been initialized, <code>false
+ * </code> if the start of the file could not be read, its compression is not
+ * supported (the recognized one is left in <code>decoder.format</code>), the
+ * memory could not be allocated or the thread could not be started.
+ */
+bool reader_init(struct reader *reader, int fd, size_t block_size, size_t margin);
+
+/**
+ * @brief Gets next block of the file.
+ * @param reader Reader of the file.
+ * @param data Output parameter for the start of the block, it is preceded by
+ * the end of the previous block (at most <code>margin</code> bytes) that is
+ * included in the returned length. Data are valid until the next call.
+ * @returns Count of the bytes at <code>data</code>, 0 at the end of the file,
+ * or <code>READER_ERROR</code> if the file could not be read.
+ */
+size_t reader_next(struct reader *reader, const unsigned char **data);
+
+/**
+ * @brief Stops the reading thread and frees the buffers.
+ * @param reader Reader to be destroyed.
+ */
+void reader_destroy(struct reader *reader);
+
+#endif
@@ -0,0 +1,277 @@
+#include "sais.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/** Slot of the array that holds no suffix yet. */
+#define EMPTY UINT32_MAX
+
+/**
+ * @brief Text on one level of the recursion, bytes on the first one and names
+ * of the substrings (stored in the suffix array) on the others.
+ */
+struct text
+{
+    const void *data;
+    size_t length;
+    /** Size of the alphabet. */
+    size_t symbols;
+    /** Whether the symbols are bytes, 32-bit integers otherwise. */
+    bool bytes;
+    /** Type of each suffix, set bit for the S-type (smaller than the next). */
+    unsigned char *types;
+};
+
+static uint32_t symbol(const struct text *text, size_t i)
+{
+    return text->bytes ? ((const unsigned char *) text->data)[i] : ((const uint32_t *) text->data)[i];
+}
+
+static bool is_s_type(const struct text *text, size_t i)
+{
+    return (text->types[i / 8] >> (i % 8)) & 1;
+}
+
+/**
+ * @brief Checks whether the suffix is the leftmost S-type one (LMS), i.e. an
+ * S-type suffix that follows an L-type one.
+ */
+static bool is_lms(const struct text *text, size_t i)
+{
+    return i > 0 && i < text->length && is_s_type(text, i) && !is_s_type(text, i - 1);
+}
+
+/**
+ * @brief Classifies the suffixes. Text is terminated by a virtual sentinel that
+ * is smaller than any symbol, so the last suffix is always L-type.
+ */
+static void classify(struct text *text)
+{
+    size_t n = text->length;
+    memset(text->types, 0, (n + 7) / 8);
+    for (size_t i = n - 1; i-- > 0;) {
+        uint32_t current = symbol(text, i);
+        uint32_t next = symbol(text, i + 1);
+        if (current < next || (current == next && is_s_type(text, i + 1))) {
+            text->types[i / 8] |= (unsigned char) (1 << (i % 8));
+        }
+    }
+}
+
+/**
+ * @brief Computes the starts (or the ends) of the buckets of the symbols.
+ * @param text Text on the current level.
+ * @param buckets Output array, <code>text->symbols</code> items.
+ * @param ends Whether the ends (exclusive) are computed instead of the starts.
+ */
+static void find_buckets(const struct text *text, uint32_t *buckets, bool ends)
+{
+    memset(buckets, 0, text->symbols * sizeof(uint32_t));
+    for (size_t i = 0; i < text->length; i++) {
+        buckets[symbol(text, i)]++;
+    }
+
+    uint32_t sum = 0;
+    for (size_t c = 0; c < text->symbols; c++) {
+        sum += buckets[c];
+        buckets[c] = ends ? sum : sum - buckets[c];
+    }
+}
+
+/**
+ * @brief Induces the order of the L-type suffixes from the sorted LMS ones and
+ * then the order of the S-type suffixes from the L-type ones.
+ */
+static void induce(const struct text *text, uint32_t *suffixes, uint32_t *buckets)
+{
+    size_t n = text->length;
+
+    // suffix before the sentinel comes first in its bucket
+    find_buckets(text, buckets, false);
+    suffixes[buckets[symbol(text, n - 1)]++] = (uint32_t) (n - 1);
+    for (size_t i = 0; i < n; i++) {
+        uint32_t j = suffixes[i];
+        if (j != EMPTY && j > 0 && !is_s_type(text, j - 1)) {
+            suffixes[buckets[symbol(text, j - 1)]++] = j - 1;
+        }
+    }
+
+    find_buckets(text, buckets, true);
+    for (size_t i = n; i-- > 0;) {
+        uint32_t j = suffixes[i];
+        if (j != EMPTY && j > 0 && is_s_type(text, j - 1)) {
+            suffixes[--buckets[symbol(text, j - 1)]] = j - 1;
+        }
+    }
+}
+
+/**
+ * @brief Checks whether the LMS substrings (up to the next LMS suffix) that
+ * start at the given positions are equal. Substring that reaches the end of
+ * the text contains the sentinel, so it is unique.
+ */
+static bool equal_lms(const struct text *text, size_t first, size_t second)
+{
+    for (size_t d = 0;; d++) {
+        if (first + d == text->length || second + d == text->length) {
+            return false;
+        }
+        if (symbol(text, first + d) != symbol(text, second + d) || is_s_type(text, first + d) != is_s_type(text, second + d)) {
+            return false;
+        }
+        if (d > 0 && (is_lms(text, first + d) || is_lms(text, second + d))) {
+            // types are the same so far, both of them end here
+            return true;
+        }
+    }
+}
+
+/**
+ * @brief Gives names to the sorted LMS substrings, equal substrings share the
+ * name. Sorted LMS suffixes are moved to the front of the array, names are
+ * stored at its end in the order of the suffixes in the text.
+ * @returns Count of the distinct names.
+ */
+static size_t name_substrings(const struct text *text, uint32_t *suffixes, size_t *lms_count)
+{
+    size_t n = text->length;
+    size_t count = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (is_lms(text, suffixes[i])) {
+            suffixes[count++] = suffixes[i];
+        }
+    }
+
+    // LMS suffixes are at least 2 apart, so halves of their positions are
+    // unique slots after the first count ones
+    for (size_t i = count; i < n; i++) {
+        suffixes[i] = EMPTY;
+    }
+    size_t names = 0;
+    uint32_t previous = EMPTY;
+    for (size_t i = 0; i < count; i++) {
+        uint32_t position = suffixes[i];
+        if (previous == EMPTY || !equal_lms(text, position, previous)) {
+            names++;
+            previous = position;
+        }
+        suffixes[count + position / 2] = (uint32_t) (names - 1);
+    }
+
+    size_t j = n;
+    for (size_t i = n; i-- > count;) {
+        if (suffixes[i] != EMPTY) {
+            suffixes[--j] = suffixes[i];
+        }
+    }
+
+    *lms_count = count;
+    return names;
+}
+
+static bool sort_suffixes(struct text *text, uint32_t *suffixes);
+
+/**
+ * @brief Sorts the LMS suffixes by their names; recursively unless the names
+ * are unique already. Sorted LMS suffixes are left at the front of the array.
+ */
+static bool sort_lms(const struct text *text, uint32_t *suffixes, size_t count, size_t names)
+{
+    size_t n = text->length;
+    uint32_t *reduced = suffixes + n - count;
+
+    if (names < count) {
+        struct text next = { reduced, count, names, false, NULL };
+        if (!sort_suffixes(&next, suffixes)) {
+            return false;
+        }
+    } else {
+        for (size_t i = 0; i < count; i++) {
+            suffixes[reduced[i]] = (uint32_t) i;
+        }
+    }
+
+    // indices into the reduced text are mapped back to the positions
+    size_t j = 0;
+    for (size_t i = 1; i < n; i++) {
+        if (is_lms(text, i)) {
+            reduced[j++] = (uint32_t) i;
+        }
+    }
+    for (size_t i = 0; i < count; i++) {
+        suffixes[i] = reduced[suffixes[i]];
+    }
+    return true;
+}
+
+/**
+ * @brief Sorts the suffixes of the text on one level of the recursion.
+ */
+static bool sort_suffixes(struct text *text, uint32_t *suffixes)
+{
+    size_t n = text->length;
+    if (n == 0) {
+        return true;
+    }
+    if (n == 1) {
+        suffixes[0] = 0;
+        return true;
+    }
+
+    text->types = malloc((n + 7) / 8);
+    uint32_t *buckets = malloc(text->symbols * sizeof(uint32_t));
+    bool sorted = text->types != NULL && buckets != NULL;
+    if (sorted) {
+        classify(text);
+
+        // LMS substrings are sorted by a single induced sort
+        find_buckets(text, buckets, true);
+        for (size_t i = 0; i < n; i++) {
+            suffixes[i] = EMPTY;
+        }
+        for (size_t i = 1; i < n; i++) {
+            if (is_lms(text, i)) {
+                suffixes[--buckets[symbol(text, i)]] = (uint32_t) i;
+            }
+        }
+        induce(text, suffixes, buckets);
+
+        size_t count;
+        size_t names = name_substrings(text, suffixes, &count);
+        sorted = sort_lms(text, suffixes, count, names);
+    }
+
+    if (sorted) {
+        // sorted LMS suffixes are put to the ends of their buckets, the rest
+        // is induced from them
+        find_buckets(text, buckets, true);
+        size_t count = 0;
+        for (size_t i = 1; i < n; i++) {
+            count += is_lms(text, i);
+        }
+        for (size_t i = count; i < n; i++) {
+            suffixes[i] = EMPTY;
+        }
+        for (size_t i = count; i-- > 0;) {
+            uint32_t j = suffixes[i];
+            suffixes[i] = EMPTY;
+            suffixes[--buckets[symbol(text, j)]] = j;
+        }
+        induce(text, suffixes, buckets);
+    }
+
+    free(buckets);
+    free(text->types);
+    text->types = NULL;
+    return sorted;
+}
+
+bool suffix_array(const unsigned char *text, uint32_t *suffixes, size_t length)
+{
+    if (length > SUFFIX_ARRAY_MAX_LENGTH) {
+        return false;
+    }
+
+    struct text bytes = { text, length, 256, true, NULL };
+    return sort_suffixes(&bytes, suffixes);
+}
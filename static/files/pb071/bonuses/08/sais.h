@@ -0,0 +1,29 @@
+#ifndef _SAIS_H
+#define _SAIS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Longest text whose suffix array can be built, positions are 32-bit and one
+ * value is left for the empty slots.
+ */
+#define SUFFIX_ARRAY_MAX_LENGTH ((size_t) UINT32_MAX - 1)
+
+/**
+ * @brief Sorts the suffixes of the text by the induced sorting (SA-IS) in
+ * linear time. Apart from the array itself, only a bit per byte of the text
+ * and the buckets of the alphabet are allocated on each level of recursion;
+ * reduced problem is solved within the array.
+ * @param text Text whose suffixes are sorted, bytes are compared as unsigned.
+ * @param suffixes Output array for the starts of the suffixes in the
+ * lexicographic order, <code>length</code> items.
+ * @param length Length of the text, at most <code>SUFFIX_ARRAY_MAX_LENGTH
+ * </code>.
+ * @returns <code>true</code> if the array has been built, <code>false</code>
+ * if the memory could not be allocated or the text is too long.
+ */
+bool suffix_array(const unsigned char *text, uint32_t *suffixes, size_t length);
+
+#endif
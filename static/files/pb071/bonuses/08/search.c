@@ -0,0 +1,158 @@
+#include "search.h"
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef HAVE_SIMD_KERNELS
+#include <immintrin.h>
+#endif
+
+bool pattern_init(struct pattern *pattern, const char *substring)
+{
+    pattern->length = strlen(substring);
+    pattern->bytes = malloc(pattern->length + 1);
+    if (pattern->bytes == NULL) {
+        return false;
+    }
+
+    pattern->letters = false;
+    for (size_t i = 0; i <= pattern->length; i++) {
+        pattern->bytes[i] = (unsigned char) tolower((unsigned char) substring[i]);
+        pattern->letters = pattern->letters || islower(pattern->bytes[i]);
+    }
+    return true;
+}
+
+void pattern_destroy(struct pattern *pattern)
+{
+    free(pattern->bytes);
+}
+
+/**
+ * @brief Checks whether the pattern occurs at the given position.
+ * @param pattern Pattern to be checked.
+ * @param data Position in the data, at least <code>pattern->length</code> bytes
+ * long.
+ * @returns <code>true</code> if the pattern occurs there, <code>false</code>
+ * otherwise.
+ */
+static bool matches(const struct pattern *pattern, const unsigned char *data)
+{
+    if (!pattern->letters) {
+        return memcmp(data, pattern->bytes, pattern->length) == 0;
+    }
+
+    for (size_t i = 0; i < pattern->length; i++) {
+        if (tolower(data[i]) != pattern->bytes[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static size_t count_scalar(const struct pattern *pattern, const unsigned char *data, size_t length)
+{
+    size_t count = 0;
+    for (size_t i = 0; i + pattern->length <= length; i++) {
+        count += tolower(data[i]) == pattern->bytes[0] && matches(pattern, data + i);
+    }
+    return count;
+}
+
+#ifdef HAVE_SIMD_KERNELS
+
+/**
+ * @brief Gets the bit that is set in the data before comparing them with the
+ * byte of the pattern. Uppercase and lowercase letters differ only in the bit
+ * 0x20, no other byte becomes a lowercase letter by setting it.
+ * @param byte Byte of the pattern (lowercase).
+ * @returns Case bit for letters, 0 otherwise.
+ */
+static char case_bit(unsigned char byte)
+{
+    return islower(byte) ? 0x20 : 0;
+}
+
+/*
+ * Both kernels compare the first and the last byte of the pattern with the
+ * data at consecutive positions, whole pattern is compared only where both of
+ * them match. Positions where the last byte would be read past the end are
+ * left for the scalar loop.
+ */
+
+__attribute__((target("sse2"))) static size_t count_sse2(const struct pattern *pattern, const unsigned char *data, size_t length)
+{
+    size_t last = pattern->length - 1;
+    const __m128i first_byte = _mm_set1_epi8((char) pattern->bytes[0]);
+    const __m128i last_byte = _mm_set1_epi8((char) pattern->bytes[last]);
+    const __m128i first_case = _mm_set1_epi8(case_bit(pattern->bytes[0]));
+    const __m128i last_case = _mm_set1_epi8(case_bit(pattern->bytes[last]));
+
+    size_t count = 0;
+    size_t i = 0;
+    for (; i + last + 16 <= length; i += 16) {
+        __m128i first = _mm_or_si128(_mm_loadu_si128((const __m128i *) (data + i)), first_case);
+        __m128i end = _mm_or_si128(_mm_loadu_si128((const __m128i *) (data + i + last)), last_case);
+        unsigned candidates = (unsigned) _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(first, first_byte), _mm_cmpeq_epi8(end, last_byte)));
+
+        while (candidates != 0) {
+            size_t offset = (size_t) __builtin_ctz(candidates);
+            candidates &= candidates - 1;
+            count += last <= 1 || matches(pattern, data + i + offset);
+        }
+    }
+    return count + count_scalar(pattern, data + i, length - i);
+}
+
+__attribute__((target("avx2"))) static size_t count_avx2(const struct pattern *pattern, const unsigned char *data, size_t length)
+{
+    size_t last = pattern->length - 1;
+    const __m256i first_byte = _mm256_set1_epi8((char) pattern->bytes[0]);
+    const __m256i last_byte = _mm256_set1_epi8((char) pattern->bytes[last]);
+    const __m256i first_case = _mm256_set1_epi8(case_bit(pattern->bytes[0]));
+    const __m256i last_case = _mm256_set1_epi8(case_bit(pattern->bytes[last]));
+
+    size_t count = 0;
+    size_t i = 0;
+    for (; i + last + 32 <= length; i += 32) {
+        __m256i first = _mm256_or_si256(_mm256_loadu_si256((const __m256i *) (data + i)), first_case);
+        __m256i end = _mm256_or_si256(_mm256_loadu_si256((const __m256i *) (data + i + last)), last_case);
+        unsigned candidates = (unsigned) _mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(first, first_byte), _mm256_cmpeq_epi8(end, last_byte)));
+
+        while (candidates != 0) {
+            size_t offset = (size_t) __builtin_ctz(candidates);
+            candidates &= candidates - 1;
+            count += last <= 1 || matches(pattern, data + i + offset);
+        }
+    }
+    return count + count_scalar(pattern, data + i, length - i);
+}
+
+#endif
+
+size_t pattern_count_simd(enum simd_level_t level, const struct pattern *pattern, const unsigned char *data, size_t length)
+{
+    if (pattern->length == 0 || length < pattern->length) {
+        return 0;
+    }
+
+#ifdef HAVE_SIMD_KERNELS
+    switch (simd_supported(level)) {
+    case SIMD_AVX2:
+        return count_avx2(pattern, data, length);
+    case SIMD_SSE2:
+        return count_sse2(pattern, data, length);
+    default:
+        break;
+    }
+#else
+    (void) level;
+#endif
+    return count_scalar(pattern, data, length);
+}
+
+size_t pattern_count(const struct pattern *pattern, const unsigned char *data, size_t length)
+{
+    return pattern_count_simd(SIMD_AVX2, pattern, data, length);
+}
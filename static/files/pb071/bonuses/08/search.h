@@ -0,0 +1,61 @@
+#ifndef _SEARCH_H
+#define _SEARCH_H
+
+#include "simd.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @brief Substring that is searched for, letters are compared without regard
+ * to their case.
+ */
+struct pattern
+{
+    /** Substring converted to the lower case. */
+    unsigned char *bytes;
+    size_t length;
+    /** Whether there are any letters in the substring. */
+    bool letters;
+};
+
+/**
+ * @brief Prepares the substring for the search.
+ * @param pattern Pattern to be initialized.
+ * @param substring Substring to be searched for.
+ * @returns <code>true</code> if the pattern has been initialized, <code>false
+ * </code> if the memory could not be allocated.
+ */
+bool pattern_init(struct pattern *pattern, const char *substring);
+
+/**
+ * @brief Frees the memory held by the pattern.
+ * @param pattern Pattern to be destroyed.
+ */
+void pattern_destroy(struct pattern *pattern);
+
+/**
+ * @brief Counts occurences of the pattern in the data, overlapping ones are
+ * counted too (e.g. "nana" is 2 times in "nanana"). Only occurences that lie
+ * completely within the data are counted.
+ *
+ * Vectorized kernels compare the first and the last byte of the pattern at
+ * 16 (SSE2) or 32 (AVX2) positions at once and only the positions where both
+ * of them match are compared as a whole.
+ *
+ * @param level Best instruction set that can be used, it is limited to the
+ * ones supported by the CPU.
+ * @param pattern Pattern to be counted.
+ * @param data Data to be searched.
+ * @param length Length of the data.
+ * @returns Count of the occurences, 0 for an empty pattern.
+ */
+size_t pattern_count_simd(enum simd_level_t level, const struct pattern *pattern, const unsigned char *data, size_t length);
+
+/**
+ * @brief Same as <code>pattern_count_simd</code> with the best instruction set
+ * supported by the CPU.
+ */
+size_t pattern_count(const struct pattern *pattern, const unsigned char *data, size_t length);
+
+#endif
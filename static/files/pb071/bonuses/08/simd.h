@@ -0,0 +1,47 @@
+#ifndef _SIMD_H
+#define _SIMD_H
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HAVE_SIMD_KERNELS
+#endif
+
+/**
+ * Instruction sets the kernels are vectorized for, ordered from the weakest.
+ */
+enum simd_level_t
+{
+    SIMD_SCALAR,
+    /** 16 bytes at once. */
+    SIMD_SSE2,
+    /** 32 bytes at once. */
+    SIMD_AVX2,
+};
+
+#define SIMD_LEVELS 3
+
+/**
+ * @brief Detects the best instruction set supported by the CPU.
+ */
+static inline enum simd_level_t simd_detect(void)
+{
+#ifdef HAVE_SIMD_KERNELS
+    if (__builtin_cpu_supports("avx2")) {
+        return SIMD_AVX2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return SIMD_SSE2;
+    }
+#endif
+    return SIMD_SCALAR;
+}
+
+/**
+ * @brief Limits the requested instruction set to the ones supported by the CPU.
+ */
+static inline enum simd_level_t simd_supported(enum simd_level_t level)
+{
+    enum simd_level_t best = simd_detect();
+    return level < best ? level : best;
+}
+
+#endif